@@ -120,14 +120,22 @@ static uint8_t bitbang_spi_rw_byte(const struct bitbang_spi_master *master,
 	uint8_t ret = 0;
 	int i;
 
+	/* SCK is low here, so only MOSI changes for the first bit. */
+	bitbang_spi_set_mosi(master, (val >> 7) & 1);
 	for (i = 7; i >= 0; i--) {
-		bitbang_spi_set_mosi(master, (val >> i) & 1);
 		programmer_delay(master->half_period);
 		bitbang_spi_set_sck(master, 1);
 		ret <<= 1;
 		ret |= bitbang_spi_get_miso(master);
 		programmer_delay(master->half_period);
-		bitbang_spi_set_sck(master, 0);
+		if (i && master->set_sck_set_mosi) {
+			/* The falling edge and the next bit in a single access. */
+			master->set_sck_set_mosi(0, (val >> (i - 1)) & 1);
+		} else {
+			bitbang_spi_set_sck(master, 0);
+			if (i)
+				bitbang_spi_set_mosi(master, (val >> (i - 1)) & 1);
+		}
 	}
 	return ret;
 }
@@ -146,10 +154,15 @@ static int bitbang_spi_send_command(struct flashctx *flash,
 	 */
 	bitbang_spi_request_bus(master);
 	bitbang_spi_set_cs(master, 0);
-	for (i = 0; i < writecnt; i++)
-		bitbang_spi_rw_byte(master, writearr[i]);
-	for (i = 0; i < readcnt; i++)
-		readarr[i] = bitbang_spi_rw_byte(master, 0);
+	if (master->transfer_bytes && !master->half_period) {
+		master->transfer_bytes(writearr, NULL, writecnt);
+		master->transfer_bytes(NULL, readarr, readcnt);
+	} else {
+		for (i = 0; i < writecnt; i++)
+			bitbang_spi_rw_byte(master, writearr[i]);
+		for (i = 0; i < readcnt; i++)
+			readarr[i] = bitbang_spi_rw_byte(master, 0);
+	}
 
 	programmer_delay(master->half_period);
 	bitbang_spi_set_cs(master, 1);
@@ -218,18 +218,142 @@ out_shutdown:
  */
 #define BP_DIVISOR(baud) ((4000000/(baud)) - 1)
 
+/* Rates tried by serialspeed=auto, in ascending order. All of them are exact with BP_DIVISOR(). */
+static const unsigned int bp_autobaud_rates[] = { 250000, 500000, 1000000, 2000000, 0 };
+
+/*
+ * Sets the Bus Pirate's UART to `baud` through the baud rate menu of the user terminal. Afterwards the
+ * Bus Pirate waits for a space at the new rate. Returns the rate it uses, 0 on error.
+ */
+static unsigned int buspirate_request_baud(unsigned int baud)
+{
+	int cnt;
+
+	/* Enter baud rate configuration mode */
+	cnt = snprintf((char *)bp_commbuf, bp_commbufsize, "b\n");
+	if (buspirate_sendrecv(bp_commbuf, cnt, 0) || buspirate_wait_for_string(bp_commbuf, ">"))
+		return 0;
+
+	/* Enter manual clock divisor entry mode */
+	cnt = snprintf((char *)bp_commbuf, bp_commbufsize, "10\n");
+	if (buspirate_sendrecv(bp_commbuf, cnt, 0) || buspirate_wait_for_string(bp_commbuf, ">"))
+		return 0;
+
+	/* Set the clock divisor to the value calculated from the requested rate */
+	cnt = snprintf((char *)bp_commbuf, bp_commbufsize, "%d\n", BP_DIVISOR(baud));
+	if (buspirate_sendrecv(bp_commbuf, cnt, 0))
+		return 0;
+	/* Let the Bus Pirate finish talking at the old rate. */
+	sleep(1);
+	sp_flush_incoming();
+
+	return 4000000 / (BP_DIVISOR(baud) + 1);
+}
+
+/* Sends a space, which also leaves the baud rate menu, and waits up to 500 ms for the prompt. */
+static int buspirate_check_prompt(void)
+{
+	static const char prompt[] = "HiZ>";
+	unsigned int i, matched = 0;
+	unsigned char c = ' ';
+
+	if (buspirate_sendrecv(&c, 1, 0))
+		return 1;
+	for (i = 0; i < 500 && matched < strlen(prompt); i++) {
+		const int ret = serialport_read_nonblock(&c, 1, 1, NULL);
+		if (ret < 0)
+			return 1;
+		if (ret > 0)
+			continue;
+		if (c == prompt[matched])
+			matched++;
+		else
+			matched = (c == prompt[0]);
+	}
+	return matched < strlen(prompt);
+}
+
+/*
+ * Set when a step of serialspeed=auto failed. From then on all further rates are refused and the fallback
+ * of sp_negotiate_baud() is left to buspirate_autobaud(), which goes back to the starting rate instead.
+ */
+static bool bp_autobaud_failed;
+
+static unsigned int buspirate_autobaud_request(unsigned int baud)
+{
+	if (bp_autobaud_failed)
+		return 0;
+	const unsigned int new_baud = buspirate_request_baud(baud);
+	if (!new_baud)
+		bp_autobaud_failed = true;
+	return new_baud;
+}
+
+static int buspirate_autobaud_confirm(void)
+{
+	if (bp_autobaud_failed)
+		return 0;
+	if (buspirate_check_prompt()) {
+		bp_autobaud_failed = true;
+		return 1;
+	}
+	return 0;
+}
+
+/* Sets the Bus Pirate back to 115200 baud with the preset of the baud rate menu. */
+static int buspirate_restore_baud(void)
+{
+	int cnt;
+
+	cnt = snprintf((char *)bp_commbuf, bp_commbufsize, "b\n");
+	if (buspirate_sendrecv(bp_commbuf, cnt, 0) || buspirate_wait_for_string(bp_commbuf, ">"))
+		return 1;
+	cnt = snprintf((char *)bp_commbuf, bp_commbufsize, "9\n");
+	if (buspirate_sendrecv(bp_commbuf, cnt, 0))
+		return 1;
+	sleep(1);
+	sp_flush_incoming();
+	return 0;
+}
+
+/*
+ * Steps the baud rate up as far as it works. If any step fails, the Bus Pirate may be left halfway in
+ * the baud rate menu or at a rate the link doesn't work at, so both sides go back to BP_DEFAULTBAUD.
+ * Returns the rate the link works at afterwards, 0 if it was lost.
+ */
+static unsigned int buspirate_autobaud(void)
+{
+	bp_autobaud_failed = false;
+	const unsigned int baud = sp_negotiate_baud(BP_DEFAULTBAUD, bp_autobaud_rates,
+						    buspirate_autobaud_request, buspirate_autobaud_confirm);
+	if (!bp_autobaud_failed)
+		return baud;
+
+	msg_pdbg("Changing the baud rate failed, going back to %u baud.\n", BP_DEFAULTBAUD);
+	/* The host is at the last rate that worked; the Bus Pirate is either there as well or in the menu. */
+	if (baud != BP_DEFAULTBAUD && !buspirate_check_prompt() && !buspirate_restore_baud() &&
+	    !serialport_config(sp_fd, BP_DEFAULTBAUD) && !buspirate_check_prompt())
+		return BP_DEFAULTBAUD;
+	/* Otherwise the Bus Pirate may still be at the starting rate, or already back there. */
+	if (!serialport_config(sp_fd, BP_DEFAULTBAUD) && !buspirate_check_prompt())
+		return BP_DEFAULTBAUD;
+
+	msg_perr("Error: Lost the link while changing the baud rate, please reset the Bus Pirate.\n");
+	return 0;
+}
+
 int buspirate_spi_init(void)
 {
 	char *tmp;
 	char *dev;
 	int i;
-	int cnt;
 	unsigned int fw_version_major = 0;
 	unsigned int fw_version_minor = 0;
 	unsigned int hw_version_major = 0;
 	unsigned int hw_version_minor = 0;
 	int spispeed = 0x7;
 	int serialspeed_index = -1;
+	int serialspeed_auto = 0;
 	int ret = 0;
 	int pullup = 0;
 
@@ -258,7 +382,9 @@ int buspirate_spi_init(void)
 
 	/* Extract serialspeed paramater */
 	tmp = extract_programmer_param("serialspeed");
-	if (tmp) {
+	if (tmp && !strcasecmp(tmp, "auto")) {
+		serialspeed_auto = 1;
+	} else if (tmp) {
 		for (i = 0; serialspeeds[i].name; i++) {
 			if (!strncasecmp(serialspeeds[i].name, tmp, strlen(serialspeeds[i].name))) {
 				serialspeed_index = i;
@@ -433,17 +559,27 @@ int buspirate_spi_init(void)
 	msg_pdbg("SPI speed is %sHz\n", spispeeds[spispeed].name);
 
 	/* Set 2M baud serial speed by default on hardware 3.0 and newer if a custom speed was not set */
-	if (serialspeed_index == -1 && BP_HWVERSION(hw_version_major, hw_version_minor) >= BP_HWVERSION(3, 0)) {
+	if (serialspeed_index == -1 && !serialspeed_auto &&
+	    BP_HWVERSION(hw_version_major, hw_version_minor) >= BP_HWVERSION(3, 0)) {
 		serialspeed_index = ARRAY_SIZE(serialspeeds) - 2;
 		msg_pdbg("Bus Pirate v3 or newer detected. Set serial speed to 2M baud.\n");
 	}
 
 	/* Set custom serial speed if specified */
-	if (serialspeed_index != -1) {
+	if (serialspeed_index != -1 || serialspeed_auto) {
 		if (BP_FWVERSION(fw_version_major, fw_version_minor) < BP_FWVERSION(5, 5)) {
 			/* This feature requires firmware 5.5 or newer */
 			msg_perr("Bus Pirate firmware 5.4 and older does not support custom serial speeds."
 				 "Using default speed of 115200 baud.\n");
+		} else if (serialspeed_auto) {
+			if (BP_HWVERSION(hw_version_major, hw_version_minor) < BP_HWVERSION(3, 0))
+				msg_pwarn("Increased serial speeds may not work on older (<3.0) Bus Pirates."
+					" Continue at your own risk.\n");
+
+			const unsigned int baud = buspirate_autobaud();
+			if (!baud)
+				return 1;
+			msg_pdbg("Serial speed is %u baud\n", baud);
 		} else if (serialspeeds[serialspeed_index].speed != BP_DEFAULTBAUD) {
 			/* Set the serial speed to match the user's choice if it doesn't already */
 
@@ -451,27 +587,8 @@ int buspirate_spi_init(void)
 				msg_pwarn("Increased serial speeds may not work on older (<3.0) Bus Pirates."
 					" Continue at your own risk.\n");
 
-			/* Enter baud rate configuration mode */
-			cnt = snprintf((char *)bp_commbuf, DEFAULT_BUFSIZE, "b\n");
-			if ((ret = buspirate_sendrecv(bp_commbuf, cnt, 0)))
-				return ret;
-			if ((ret = buspirate_wait_for_string(bp_commbuf, ">")))
-				return ret;
-
-			/* Enter manual clock divisor entry mode */
-			cnt = snprintf((char *)bp_commbuf, DEFAULT_BUFSIZE, "10\n");
-			if ((ret = buspirate_sendrecv(bp_commbuf, cnt, 0)))
-				return ret;
-			if ((ret = buspirate_wait_for_string(bp_commbuf, ">")))
-				return ret;
-
-			/* Set the clock divisor to the value calculated from the user's input */
-			cnt = snprintf((char *)bp_commbuf, DEFAULT_BUFSIZE, "%d\n",
-				BP_DIVISOR(serialspeeds[serialspeed_index].speed));
-
-			if ((ret = buspirate_sendrecv(bp_commbuf, cnt, 0)))
-				return ret;
-			sleep(1);
+			if (!buspirate_request_baud(serialspeeds[serialspeed_index].speed))
+				return 1;
 
 			/* Reconfigure the host's serial baud rate to the new value */
 			if ((ret = serialport_config(sp_fd, serialspeeds[serialspeed_index].speed))) {
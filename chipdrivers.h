@@ -63,6 +63,13 @@ int spi_read_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start, u
 int spi_write_chunked(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len, unsigned int chunksize);
 int spi_enter_4ba(struct flashctx *flash);
 int spi_exit_4ba(struct flashctx *flash);
+int spi_set_extended_address(struct flashctx *flash, uint8_t addr_high);
+int spi_prepare_io_mode(struct flashctx *flash);
+int spi_finalize_io_mode(struct flashctx *flash);
+int spi_die_busy(struct flashctx *flash, unsigned int die);
+int spi_erase_suspend(struct flashctx *flash);
+int spi_erase_resume(struct flashctx *flash);
+int spi_disable_blockprotect_dies(struct flashctx *flash);
 
 
 /* spi25_statusreg.c */
@@ -107,6 +114,9 @@ int spi_disable_blockprotect_bp2_ep_srwd(struct flashctx *flash);
 int spi_prettyprint_status_register_sst25(struct flashctx *flash);
 int spi_prettyprint_status_register_sst25vf016(struct flashctx *flash);
 int spi_prettyprint_status_register_sst25vf040b(struct flashctx *flash);
+int spi_protection_bp2_tb_sec_cmp(struct flashctx *flash, struct protection *prot);
+int spi_prettyprint_status_register_bp2_tb_sec_cmp(struct flashctx *flash);
+int spi_disable_blockprotect_bp2_tb_sec_cmp(struct flashctx *flash);
 int w25q_get_adp_status(struct flashctx *flash);
 int w25q_set_adp_status(struct flashctx *flash, int enable);
 
@@ -160,6 +170,14 @@ int unlock_regspace2_block_eraser_1(struct flashctx *flash);
 int printlock_regspace2_uniform_64k(struct flashctx *flash);
 int printlock_regspace2_block_eraser_0(struct flashctx *flash);
 int printlock_regspace2_block_eraser_1(struct flashctx *flash);
+int protection_regspace2_uniform_64k(struct flashctx *flash, struct protection *prot);
+int protection_regspace2_uniform_32k(struct flashctx *flash, struct protection *prot);
+int protection_regspace2_block_eraser_0(struct flashctx *flash, struct protection *prot);
+int protection_regspace2_block_eraser_1(struct flashctx *flash, struct protection *prot);
+int unprotect_regspace2_uniform_64k(struct flashctx *flash, chipoff_t start, chipsize_t len);
+int unprotect_regspace2_uniform_32k(struct flashctx *flash, chipoff_t start, chipsize_t len);
+int unprotect_regspace2_block_eraser_0(struct flashctx *flash, chipoff_t start, chipsize_t len);
+int unprotect_regspace2_block_eraser_1(struct flashctx *flash, chipoff_t start, chipsize_t len);
 
 /* sst28sf040.c */
 int erase_chip_28sf040(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
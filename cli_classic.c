@@ -22,6 +22,7 @@
  */
 
 #include <stdio.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <string.h>
@@ -43,7 +44,10 @@ static void cli_classic_usage(const char *name)
 	       "-z|"
 #endif
 	       "-p <programmername>[:<parameters>] [-c <chipname>]\n"
-	       "[-E|(-r|-w|-v) <file>] [(-l <layoutfile>|--ifd) [-i <imagename>]...] [-n] [-N] [-f]]\n"
+	       "[-E|(-r|-w|-v) <file>] [(-l <layoutfile>|--ifd|--fmap|--fmap-file <file>)\n"
+	       "[-i <imagename>]... [--include-changed <reffile>]] [-n] [-N] [-f]]\n"
+	       "[(--region-hashes <file>|--region-hashes-region <name>) [--hash-samples <n>]]\n"
+	       "[--backup-against <reffile>] [--stream] [--consistent-read] [--erase-suspend]\n"
 	       "[-V[V[V]]] [-o <logfile>]\n\n", name);
 
 	printf(" -h | --help                        print this help text\n"
@@ -59,7 +63,17 @@ static void cli_classic_usage(const char *name)
 	       " -N | --noverify-all                verify included regions only (cf. -i)\n"
 	       " -l | --layout <layoutfile>         read ROM layout from <layoutfile>\n"
 	       "      --ifd                         read layout from an Intel Firmware Descriptor\n"
+	       "      --fmap                        read layout from the FMAP on the flash chip\n"
+	       "      --fmap-file <file>            read layout from the FMAP in <file>\n"
 	       " -i | --image <name>                only flash image <name> from flash layout\n"
+	       "      --include-changed <reffile>   also flash all images that differ from <reffile>\n"
+	       "      --region-hashes <file>        skip regions whose hash in <file> matches\n"
+	       "      --region-hashes-region <name> like --region-hashes, stored in region <name>\n"
+	       "      --hash-samples <n>            verify <n> random chunks of skipped regions\n"
+	       "      --backup-against <reffile>    -r/-w/-v <file> is a delta against <reffile>\n"
+	       "      --stream                      write <file> block by block instead of as a whole\n"
+	       "      --consistent-read             read twice and re-read blocks that differ\n"
+	       "      --erase-suspend               verify written blocks while suspending erases\n"
 	       " -o | --output <logfile>            log output to <logfile>\n"
 	       " -L | --list-supported              print supported devices\n"
 #if CONFIG_PRINT_WIKI == 1
@@ -86,6 +100,169 @@ static void cli_classic_abort_usage(void)
 	exit(1);
 }
 
+/* Includes all layout regions where the image to write differs from the reference image. */
+static int include_changed_regions(struct flashrom_layout *const layout, const size_t flash_size,
+				   const char *const reffile, const char *const imagefile)
+{
+	int ret = 1;
+
+	uint8_t *const reference = malloc(flash_size);
+	uint8_t *const image = malloc(flash_size);
+	if (!reference || !image) {
+		msg_gerr("Out of memory!\n");
+		goto _free_ret;
+	}
+	/* Short files are compared as if they were padded with erased bytes. */
+	memset(reference, 0xff, flash_size);
+	memset(image, 0xff, flash_size);
+
+	if (read_buf_from_file(reference, flash_size, reffile) ||
+	    read_buf_from_file(image, flash_size, imagefile))
+		goto _free_ret;
+
+	ret = flashrom_layout_include_changed(layout, reference, image, flash_size);
+
+_free_ret:
+	free(image);
+	free(reference);
+	return ret;
+}
+
+/* Reads the layout from the FMAP in `fmapfile`. */
+static int read_fmap_from_file(struct flashrom_layout **const layout, struct flashctx *const flash,
+			       const char *const fmapfile)
+{
+	const size_t flash_size = flash->chip->total_size * 1024;
+	int ret = 1;
+
+	uint8_t *const buf = malloc(flash_size);
+	if (!buf) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+	memset(buf, 0xff, flash_size);
+
+	if (!read_buf_from_file(buf, flash_size, fmapfile))
+		ret = flashrom_layout_read_fmap_from_buffer(layout, flash, buf, flash_size);
+
+	free(buf);
+	return ret;
+}
+
+/* Reads a whole text file. A missing file is not an error, `*text` is NULL then. */
+static int read_text_file(const char *const filename, char **const text)
+{
+	*text = NULL;
+
+	FILE *const file = fopen(filename, "rb");
+	if (!file) {
+		if (errno == ENOENT) {
+			msg_ginfo("Region hash file \"%s\" doesn't exist yet.\n", filename);
+			return 0;
+		}
+		msg_gerr("Error: opening file \"%s\" failed: %s\n", filename, strerror(errno));
+		return 1;
+	}
+
+	struct stat file_stat;
+	if (fstat(fileno(file), &file_stat) != 0) {
+		msg_gerr("Error: getting metadata of file \"%s\" failed: %s\n", filename, strerror(errno));
+		(void)fclose(file);
+		return 1;
+	}
+
+	*text = malloc(file_stat.st_size + 1);
+	if (!*text) {
+		msg_gerr("Out of memory!\n");
+		(void)fclose(file);
+		return 1;
+	}
+	const size_t len = fread(*text, 1, file_stat.st_size, file);
+	(*text)[len] = '\0';
+	(void)fclose(file);
+	return 0;
+}
+
+static int write_text_file(const char *const filename, const char *const text)
+{
+	FILE *const file = fopen(filename, "wb");
+	if (!file) {
+		msg_gerr("Error: opening file \"%s\" failed: %s\n", filename, strerror(errno));
+		return 1;
+	}
+	const int ret = fputs(text, file) < 0;
+	if (fclose(file) || ret) {
+		msg_gerr("Error: writing file \"%s\" failed: %s\n", filename, strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+/*
+ * Like do_write(), but skips all regions that are up to date according
+ * to the region hashes, which are updated after a successful write.
+ */
+static int do_write_with_region_hashes(struct flashctx *const flash, struct flashrom_layout *const layout,
+				       const char *const filename, const char *const hashfile,
+				       const char *const hashregion, const unsigned int samples)
+{
+	const size_t flash_size = flash->chip->total_size * 1024;
+	char *old_hashes = NULL, *new_hashes = NULL;
+	size_t remaining, i;
+	int ret = 1;
+
+	uint8_t *const newcontents = malloc(flash_size);
+	if (!newcontents) {
+		msg_gerr("Out of memory!\n");
+		goto _free_ret;
+	}
+	if (read_buf_from_file(newcontents, flash_size, filename))
+		goto _free_ret;
+
+	if (hashfile) {
+		if (read_text_file(hashfile, &old_hashes))
+			goto _free_ret;
+	} else {
+		if (flashrom_region_hashes_read(flash, layout, hashregion, newcontents, flash_size, &old_hashes))
+			goto _free_ret;
+		/* The hash region is maintained separately. */
+		for (i = 0; i < layout->num_entries; ++i) {
+			if (!strcmp(layout->entries[i].name, hashregion))
+				layout->entries[i].included = false;
+		}
+	}
+
+	if (flashrom_layout_exclude_up_to_date(flash, layout, old_hashes, newcontents, flash_size,
+					       samples, &remaining))
+		goto _free_ret;
+	if (!remaining) {
+		msg_ginfo("All regions are up to date, nothing to write.\n");
+		ret = 0;
+		goto _free_ret;
+	}
+
+	ret = flashrom_image_write(flash, newcontents, flash_size);
+	if (ret)
+		goto _free_ret;
+
+	ret = 1;
+	new_hashes = flashrom_region_hashes_update(layout, old_hashes, newcontents, flash_size, hashregion);
+	if (!new_hashes)
+		goto _free_ret;
+	if (hashfile)
+		ret = write_text_file(hashfile, new_hashes);
+	else
+		ret = flashrom_region_hashes_write(flash, layout, hashregion, new_hashes);
+	if (ret)
+		msg_gerr("Failed to update the region hashes, the next write won't skip any region.\n");
+
+_free_ret:
+	free(new_hashes);
+	free(old_hashes);
+	free(newcontents);
+	return ret;
+}
+
 static int check_filename(char *filename, char *type)
 {
 	if (!filename || (filename[0] == '\0')) {
@@ -106,7 +283,7 @@ int main(int argc, char *argv[])
 	struct flashctx *fill_flash;
 	const char *name;
 	int namelen, opt, i, j;
-	int startchip = -1, chipcount = 0, option_index = 0, force = 0, ifd = 0;
+	int startchip = -1, chipcount = 0, option_index = 0, force = 0, ifd = 0, fmap = 0;
 #if CONFIG_PRINT_WIKI == 1
 	int list_supported_wiki = 0;
 #endif
@@ -130,6 +307,16 @@ int main(int argc, char *argv[])
 		{"force",		0, NULL, 'f'},
 		{"layout",		1, NULL, 'l'},
 		{"ifd",			0, NULL, 0x0100},
+		{"fmap",		0, NULL, 0x0104},
+		{"fmap-file",		1, NULL, 0x0105},
+		{"include-changed",	1, NULL, 0x0106},
+		{"region-hashes",	1, NULL, 0x0107},
+		{"region-hashes-region",	1, NULL, 0x0108},
+		{"hash-samples",	1, NULL, 0x0109},
+		{"backup-against",	1, NULL, 0x010a},
+		{"stream",		0, NULL, 0x010b},
+		{"consistent-read",	0, NULL, 0x010c},
+		{"erase-suspend",	0, NULL, 0x010d},
 		{"image",		1, NULL, 'i'},
 		{"list-supported",	0, NULL, 'L'},
 		{"list-supported-wiki",	0, NULL, 'z'},
@@ -145,6 +332,13 @@ int main(int argc, char *argv[])
 
 	char *filename = NULL;
 	char *layoutfile = NULL;
+	char *fmapfile = NULL;
+	char *changedref = NULL;
+	char *hashfile = NULL;
+	char *hashregion = NULL;
+	unsigned int hash_samples = 0;
+	char *deltaref = NULL;
+	int stream = 0, consistent_read = 0, erase_suspend = 0;
 #ifndef STANDALONE
 	char *logfile = NULL;
 #endif /* !STANDALONE */
@@ -237,6 +431,10 @@ int main(int argc, char *argv[])
 				fprintf(stderr, "Error: --layout and --ifd both specified. Aborting.\n");
 				cli_classic_abort_usage();
 			}
+			if (fmap || fmapfile) {
+				fprintf(stderr, "Error: --layout and --fmap(-file) both specified. Aborting.\n");
+				cli_classic_abort_usage();
+			}
 			layoutfile = strdup(optarg);
 			break;
 		case 0x0100:
@@ -244,8 +442,73 @@ int main(int argc, char *argv[])
 				fprintf(stderr, "Error: --layout and --ifd both specified. Aborting.\n");
 				cli_classic_abort_usage();
 			}
+			if (fmap || fmapfile) {
+				fprintf(stderr, "Error: --fmap(-file) and --ifd both specified. Aborting.\n");
+				cli_classic_abort_usage();
+			}
 			ifd = 1;
 			break;
+		case 0x0104:
+		case 0x0105:
+			if (fmap || fmapfile) {
+				fprintf(stderr, "Error: --fmap or --fmap-file specified more than once. Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			if (layoutfile) {
+				fprintf(stderr, "Error: --layout and --fmap(-file) both specified. Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			if (ifd) {
+				fprintf(stderr, "Error: --fmap(-file) and --ifd both specified. Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			if (opt == 0x0105)
+				fmapfile = strdup(optarg);
+			else
+				fmap = 1;
+			break;
+		case 0x0106:
+			if (changedref) {
+				fprintf(stderr, "Error: --include-changed specified more than once. Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			changedref = strdup(optarg);
+			break;
+		case 0x0107:
+		case 0x0108:
+			if (hashfile || hashregion) {
+				fprintf(stderr, "Error: --region-hashes(-region) specified more than once. "
+					"Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			if (opt == 0x0107)
+				hashfile = strdup(optarg);
+			else
+				hashregion = strdup(optarg);
+			break;
+		case 0x0109:
+			hash_samples = strtoul(optarg, &tempstr, 0);
+			if (*optarg == '\0' || *tempstr != '\0') {
+				fprintf(stderr, "Error: Invalid number of hash samples \"%s\". Aborting.\n", optarg);
+				cli_classic_abort_usage();
+			}
+			break;
+		case 0x010a:
+			if (deltaref) {
+				fprintf(stderr, "Error: --backup-against specified more than once. Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			deltaref = strdup(optarg);
+			break;
+		case 0x010b:
+			stream = 1;
+			break;
+		case 0x010c:
+			consistent_read = 1;
+			break;
+		case 0x010d:
+			erase_suspend = 1;
+			break;
 		case 'i':
 			tempstr = strdup(optarg);
 			if (register_include_arg(tempstr)) {
@@ -374,6 +637,61 @@ int main(int argc, char *argv[])
 	if (layoutfile && check_filename(layoutfile, "layout")) {
 		cli_classic_abort_usage();
 	}
+	if (fmapfile && check_filename(fmapfile, "fmap")) {
+		cli_classic_abort_usage();
+	}
+	if ((hashfile || hashregion) && !write_it) {
+		fprintf(stderr, "Error: --region-hashes(-region) only works with --write. Aborting.\n");
+		cli_classic_abort_usage();
+	}
+	if (deltaref) {
+		if (check_filename(deltaref, "reference"))
+			cli_classic_abort_usage();
+		if (!(read_it | write_it | verify_it)) {
+			fprintf(stderr, "Error: --backup-against only works with --read, --write or --verify. "
+				"Aborting.\n");
+			cli_classic_abort_usage();
+		}
+		if (hashfile || hashregion || changedref) {
+			fprintf(stderr, "Error: --backup-against can't be combined with --region-hashes(-region) "
+				"or --include-changed. Aborting.\n");
+			cli_classic_abort_usage();
+		}
+	}
+	if (stream && (!write_it || deltaref || hashfile || hashregion)) {
+		fprintf(stderr, "Error: --stream only works with --write and can't be combined with "
+			"--backup-against or --region-hashes(-region). Aborting.\n");
+		cli_classic_abort_usage();
+	}
+	if (consistent_read && (!read_it || deltaref)) {
+		fprintf(stderr, "Error: --consistent-read only works with --read and can't be combined with "
+			"--backup-against. Aborting.\n");
+		cli_classic_abort_usage();
+	}
+	if (erase_suspend && (!write_it || stream || dont_verify_it)) {
+		fprintf(stderr, "Error: --erase-suspend only works with --write and can't be combined with "
+			"--stream or --noverify. Aborting.\n");
+		cli_classic_abort_usage();
+	}
+	if (hashfile && check_filename(hashfile, "region hash")) {
+		cli_classic_abort_usage();
+	}
+	if (hashregion && !layoutfile && !ifd && !fmap && !fmapfile) {
+		fprintf(stderr, "Error: --region-hashes-region needs a layout. Aborting.\n");
+		cli_classic_abort_usage();
+	}
+	if (changedref) {
+		if (check_filename(changedref, "reference"))
+			cli_classic_abort_usage();
+		if (!write_it) {
+			fprintf(stderr, "Error: --include-changed only works with --write. Aborting.\n");
+			cli_classic_abort_usage();
+		}
+		if (!layoutfile && !ifd && !fmap && !fmapfile) {
+			fprintf(stderr, "Error: --include-changed needs a layout. Aborting.\n");
+			cli_classic_abort_usage();
+		}
+	}
 
 #ifndef STANDALONE
 	if (logfile && check_filename(logfile, "log"))
@@ -410,7 +728,7 @@ int main(int argc, char *argv[])
 		ret = 1;
 		goto out;
 	}
-	if (!ifd && process_include_args(get_global_layout())) {
+	if (!ifd && !fmap && !fmapfile && process_include_args(get_global_layout())) {
 		ret = 1;
 		goto out;
 	}
@@ -563,33 +881,66 @@ int main(int argc, char *argv[])
 		goto out_shutdown;
 	}
 
+	flashrom_flag_set(fill_flash, FLASHROM_FLAG_FORCE, !!force);
+#if CONFIG_INTERNAL == 1
+	flashrom_flag_set(fill_flash, FLASHROM_FLAG_FORCE_BOARDMISMATCH, !!force_boardmismatch);
+#endif
+	flashrom_flag_set(fill_flash, FLASHROM_FLAG_VERIFY_AFTER_WRITE, !dont_verify_it);
+	flashrom_flag_set(fill_flash, FLASHROM_FLAG_VERIFY_WHOLE_CHIP, !dont_verify_all);
+	flashrom_flag_set(fill_flash, FLASHROM_FLAG_CONSISTENT_READ, !!consistent_read);
+	flashrom_flag_set(fill_flash, FLASHROM_FLAG_ERASE_SUSPEND, !!erase_suspend);
+
+	/* Prepare the chip only once for all accesses below. */
+	if ((read_it | write_it | erase_it | verify_it) && flashrom_session_begin(fill_flash)) {
+		ret = 1;
+		goto out_shutdown;
+	}
+
 	if (layoutfile) {
 		layout = get_global_layout();
 	} else if (ifd && (flashrom_layout_read_from_ifd(&layout, fill_flash, NULL, 0) ||
 			   process_include_args(layout))) {
 		ret = 1;
 		goto out_shutdown;
+	} else if (fmap && (flashrom_layout_read_fmap_from_rom(&layout, fill_flash) ||
+			    process_include_args(layout))) {
+		ret = 1;
+		goto out_shutdown;
+	} else if (fmapfile && (read_fmap_from_file(&layout, fill_flash, fmapfile) ||
+				process_include_args(layout))) {
+		ret = 1;
+		goto out_shutdown;
+	}
+
+	if (changedref && include_changed_regions(layout, fill_flash->chip->total_size * 1024,
+						  changedref, filename)) {
+		ret = 1;
+		goto out_shutdown;
 	}
 
 	flashrom_layout_set(fill_flash, layout);
-	flashrom_flag_set(fill_flash, FLASHROM_FLAG_FORCE, !!force);
-#if CONFIG_INTERNAL == 1
-	flashrom_flag_set(fill_flash, FLASHROM_FLAG_FORCE_BOARDMISMATCH, !!force_boardmismatch);
-#endif
-	flashrom_flag_set(fill_flash, FLASHROM_FLAG_VERIFY_AFTER_WRITE, !dont_verify_it);
-	flashrom_flag_set(fill_flash, FLASHROM_FLAG_VERIFY_WHOLE_CHIP, !dont_verify_all);
 
 	/* FIXME: We should issue an unconditional chip reset here. This can be
 	 * done once we have a .reset function in struct flashchip.
 	 * Give the chip time to settle.
 	 */
 	programmer_delay(100000);
-	if (read_it) {
+	if (read_it && deltaref) {
+		ret = do_read_delta(fill_flash, filename, deltaref);
+	} else if (read_it) {
 		ret = do_read(fill_flash, filename);
 	} else if (erase_it) {
 		ret = do_erase(fill_flash);
+	} else if (write_it && deltaref) {
+		ret = do_write_delta(fill_flash, filename, deltaref);
+	} else if (write_it && (hashfile || hashregion)) {
+		ret = do_write_with_region_hashes(fill_flash, layout, filename, hashfile, hashregion, hash_samples);
+	} else if (write_it && stream) {
+		ret = do_write_stream(fill_flash, filename);
 	} else if (write_it) {
 		ret = do_write(fill_flash, filename);
+	} else if (verify_it && deltaref) {
+		ret = do_verify_delta(fill_flash, filename, deltaref);
 	} else if (verify_it) {
 		ret = do_verify(fill_flash, filename);
 	} else if (adp_status) {
@@ -604,6 +955,7 @@ int main(int argc, char *argv[])
 	flashrom_layout_release(layout);
 
 out_shutdown:
+	flashrom_session_end(&flashes[0]);
 	programmer_shutdown();
 out:
 	for (i = 0; i < chipcount; i++)
@@ -612,6 +964,11 @@ out:
 	layout_cleanup();
 	free(filename);
 	free(layoutfile);
+	free(fmapfile);
+	free(changedref);
+	free(hashfile);
+	free(hashregion);
+	free(deltaref);
 	free(pparam);
 	/* clean up global variables */
 	free((char *)chip_to_probe); /* Silence! Freeing is not modifying contents. */
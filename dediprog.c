@@ -387,13 +387,96 @@ static int dediprog_set_spi_speed(unsigned int spispeed_idx)
 	return 0;
 }
 
-static void fill_rw_cmd_payload(uint8_t *data_packet, unsigned int count, uint8_t dedi_spi_cmd, unsigned int *value, unsigned int *idx, unsigned int start) {
+/* Read or write mode of a bulk command and the SPI opcode it should use. */
+struct dediprog_rw_mode {
+	uint8_t mode;
+	uint8_t opcode;
+	bool four_byte; /* The chip gets all four address bytes. */
+};
+
+/* Picks the fastest bulk read mode that both the chip and the protocol support. */
+static struct dediprog_rw_mode dediprog_read_mode(const struct flashctx *flash)
+{
+	const uint32_t features = flash->chip->feature_bits;
+
+	/* Only the new protocol passes 32-bit addresses, see dediprog_init(). */
+	if (spi_master_4ba(flash)) {
+		if (features & FEATURE_4BA_FAST_READ)
+			return (struct dediprog_rw_mode){ READ_MODE_4B_ADDR_FAST_0x0C, JEDEC_READ_4BA_FAST, true };
+		if (flash->in_4ba_mode)
+			return (struct dediprog_rw_mode){ READ_MODE_4B_ADDR_FAST, JEDEC_FAST_READ, true };
+	}
+	if (features & FEATURE_FAST_READ)
+		return (struct dediprog_rw_mode){ READ_MODE_FAST, 0, false };
+	return (struct dediprog_rw_mode){ READ_MODE_STD, 0, false };
+}
+
+static struct dediprog_rw_mode dediprog_write_mode(const struct flashctx *flash, uint8_t dedi_spi_cmd)
+{
+	if (dedi_spi_cmd == WRITE_MODE_PAGE_PGM && spi_master_4ba(flash)) {
+		if (flash->chip->feature_bits & FEATURE_4BA_WRITE)
+			return (struct dediprog_rw_mode){ WRITE_MODE_4B_ADDR_256B_PAGE_PGM_0x12,
+							  JEDEC_BYTE_PROGRAM_4BA, true };
+		if (flash->in_4ba_mode)
+			return (struct dediprog_rw_mode){ WRITE_MODE_4B_ADDR_256B_PAGE_PGM, JEDEC_BYTE_PROGRAM, true };
+	}
+	return (struct dediprog_rw_mode){ dedi_spi_cmd, 0, false };
+}
+
+#define DEDIPROG_3BA_AREA_SIZE (16 * 1024 * 1024)
+
+/*
+ * Returns how many bytes from start on bulk commands in the given mode can
+ * reach. Without 4-byte addresses, the chip would wrap around at 16 MiB
+ * unless the extended address register selects the next 16 MiB. Stacked
+ * dies have to be selected with separate commands.
+ */
+static unsigned int dediprog_bulk_limit(const struct flashctx *flash, const struct dediprog_rw_mode *mode,
+					unsigned int start, unsigned int len)
+{
+	if (flash->chip->dies > 1)
+		return 0;
+	if (mode->four_byte || flash->chip->feature_bits & FEATURE_4BA_EXT_ADDR)
+		return len;
+	if (start >= DEDIPROG_3BA_AREA_SIZE)
+		return 0;
+	return min(len, DEDIPROG_3BA_AREA_SIZE - start);
+}
+
+/*
+ * Returns how many bytes from start on a single bulk command can transfer.
+ * The chunk count is only 16 bits wide, and with 3-byte addresses a command
+ * can't cross a 16 MiB boundary.
+ */
+static unsigned int dediprog_bulk_cmd_len(const struct dediprog_rw_mode *mode, unsigned int chunksize,
+					  unsigned int start, unsigned int len)
+{
+	len = min(len, 0x8000 * chunksize);
+	if (!mode->four_byte)
+		len = min(len, DEDIPROG_3BA_AREA_SIZE - start % DEDIPROG_3BA_AREA_SIZE);
+	return len;
+}
+
+/* Points the extended address register at the 16 MiB area of a 3-byte address bulk command. */
+static int dediprog_prepare_address(struct flashctx *flash, const struct dediprog_rw_mode *mode, unsigned int start)
+{
+	if (mode->four_byte || !(flash->chip->feature_bits & FEATURE_4BA_EXT_ADDR))
+		return 0;
+	return spi_set_extended_address(flash, start >> 24);
+}
+
+static void fill_rw_cmd_payload(uint8_t *data_packet, unsigned int count, const struct dediprog_rw_mode *mode,
+				unsigned int *value, unsigned int *idx, unsigned int start) {
 	/* First 5 bytes are common in both generations. */
 	data_packet[0] = count & 0xff;
 	data_packet[1] = (count >> 8) & 0xff;
 	data_packet[2] = 0; /* RFU */
-	data_packet[3] = dedi_spi_cmd; /* Read/Write Mode (currently READ_MODE_STD, WRITE_MODE_PAGE_PGM or WRITE_MODE_2B_AAI) */
-	data_packet[4] = 0; /* "Opcode". Specs imply necessity only for READ_MODE_4B_ADDR_FAST and WRITE_MODE_4B_ADDR_256B_PAGE_PGM */
+	data_packet[3] = mode->mode; /* Read/Write Mode */
+	data_packet[4] = mode->opcode; /* "Opcode". Specs imply necessity only for the 4-byte address modes */
+
+	/* In 3-byte address modes, the upper byte is in the extended address register. */
+	if (!mode->four_byte)
+		start &= 0xffffff;
 
 	if (is_new_prot()) {
 		*value = *idx = 0;
@@ -434,10 +517,18 @@ static int dediprog_spi_bulk_read(struct flashctx *flash, uint8_t *buf, unsigned
 	if (len == 0)
 		return 0;
 
+	const struct dediprog_rw_mode mode = dediprog_read_mode(flash);
+	const unsigned int cmd_len = dediprog_bulk_cmd_len(&mode, chunksize, start, len);
+	if (cmd_len < len)
+		return dediprog_spi_bulk_read(flash, buf, start, cmd_len) ||
+		       dediprog_spi_bulk_read(flash, buf + cmd_len, start + cmd_len, len - cmd_len);
+
 	/* Command packet size of protocols: new 10 B, old 5 B. */
 	uint8_t data_packet[is_new_prot() ? 10 : 5];
 	unsigned int value, idx;
-	fill_rw_cmd_payload(data_packet, count, READ_MODE_STD, &value, &idx, start);
+	if (dediprog_prepare_address(flash, &mode, start))
+		return 1;
+	fill_rw_cmd_payload(data_packet, count, &mode, &value, &idx, start);
 
 	int ret = dediprog_write(CMD_READ, value, idx, data_packet, sizeof(data_packet));
 	if (ret != sizeof(data_packet)) {
@@ -518,6 +609,8 @@ static int dediprog_spi_read(struct flashctx *flash, uint8_t *buf, unsigned int
 
 	/* Round down. */
 	bulklen = (len - residue) / chunksize * chunksize;
+	const struct dediprog_rw_mode mode = dediprog_read_mode(flash);
+	bulklen = dediprog_bulk_limit(flash, &mode, start + residue, bulklen);
 	ret = dediprog_spi_bulk_read(flash, buf + residue, start + residue, bulklen);
 	if (ret)
 		goto err;
@@ -576,10 +669,19 @@ static int dediprog_spi_bulk_write(struct flashctx *flash, const uint8_t *buf, u
 	if (len == 0)
 		return 0;
 
+	const struct dediprog_rw_mode mode = dediprog_write_mode(flash, dedi_spi_cmd);
+	const unsigned int cmd_len = dediprog_bulk_cmd_len(&mode, chunksize, start, len);
+	if (cmd_len < len)
+		return dediprog_spi_bulk_write(flash, buf, chunksize, start, cmd_len, dedi_spi_cmd) ||
+		       dediprog_spi_bulk_write(flash, buf + cmd_len, chunksize, start + cmd_len, len - cmd_len,
+					       dedi_spi_cmd);
+
 	/* Command packet size of protocols: new 10 B, old 5 B. */
 	uint8_t data_packet[is_new_prot() ? 10 : 5];
 	unsigned int value, idx;
-	fill_rw_cmd_payload(data_packet, count, dedi_spi_cmd, &value, &idx, start);
+	if (dediprog_prepare_address(flash, &mode, start))
+		return 1;
+	fill_rw_cmd_payload(data_packet, count, &mode, &value, &idx, start);
 	int ret = dediprog_write(CMD_WRITE, value, idx, data_packet, sizeof(data_packet));
 	if (ret != sizeof(data_packet)) {
 		msg_perr("Command Write SPI Bulk failed, %s!\n", libusb_error_name(ret));
@@ -633,6 +735,8 @@ static int dediprog_spi_write(struct flashctx *flash, const uint8_t *buf,
 
 	/* Round down. */
 	bulklen = (len - residue) / chunksize * chunksize;
+	const struct dediprog_rw_mode mode = dediprog_write_mode(flash, dedi_spi_cmd);
+	bulklen = dediprog_bulk_limit(flash, &mode, start + residue, bulklen);
 	ret = dediprog_spi_bulk_write(flash, buf + residue, chunksize, start + residue, bulklen, dedi_spi_cmd);
 	if (ret) {
 		dediprog_set_leds(LED_ERROR);
@@ -909,7 +1013,7 @@ static int parse_voltage(char *voltage)
 	return millivolt;
 }
 
-static const struct spi_master spi_master_dediprog = {
+static struct spi_master spi_master_dediprog = {
 	.type		= SPI_CONTROLLER_DEDIPROG,
 	.max_data_read	= 16, /* 18 seems to work fine as well, but 19 times out sometimes with FW 5.15. */
 	.max_data_write	= 16,
@@ -1097,6 +1201,12 @@ int dediprog_init(void)
 	if (dediprog_standalone_mode())
 		return 1;
 
+	/* The new protocol passes 32-bit addresses to the bulk commands. */
+	if (is_new_prot())
+		spi_master_dediprog.features |= SPI_MASTER_4BA;
+	else
+		spi_master_dediprog.features &= ~SPI_MASTER_4BA;
+
 	if (register_spi_master(&spi_master_dediprog) || dediprog_set_leds(LED_NONE))
 		return 1;
 
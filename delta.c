@@ -0,0 +1,431 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Delta images hold only the blocks of a flash image that differ from a
+ * reference image. All fields are little endian:
+ *
+ *   "FRDELTA2"	signature
+ *   u32	size of the flash chip
+ *   u32	block size used for the comparison
+ *   u64	FNV-1a hash of the reference image
+ *   u32	number of ranges that were read
+ *
+ * followed by the ranges that were read, i.e. the included layout regions:
+ *
+ *   u32	first byte
+ *   u32	last byte
+ *
+ * followed by any number of records until the end of the file:
+ *
+ *   u32	offset
+ *   u32	length
+ *   u8[length]	data
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flash.h"
+#include "layout.h"
+#include "libflashrom.h"
+
+#define DELTA_SIGNATURE		"FRDELTA2"
+#define DELTA_HEADER_LEN	(8 + 4 + 4 + 8 + 4)
+#define DELTA_MAX_RANGES	1024
+/* Granularity of the comparison, i.e. the smallest record. */
+#define DELTA_BLOCK_SIZE	4096
+/* Bytes read from the chip at once. Large reads are cheaper for most programmers. */
+#define DELTA_READ_SIZE		(64 * 1024)
+
+/* The ranges a delta was read from, restores only touch these. */
+struct delta_layout {
+	struct flashrom_layout base;
+	struct romentry entries[];
+};
+
+static void delta_put_le(uint8_t *const buf, uint64_t val, const unsigned int len)
+{
+	unsigned int i;
+
+	for (i = 0; i < len; ++i, val >>= 8)
+		buf[i] = val & 0xff;
+}
+
+static uint64_t delta_get_le(const uint8_t *const buf, const unsigned int len)
+{
+	uint64_t val = 0;
+	unsigned int i;
+
+	for (i = len; i > 0; --i)
+		val = val << 8 | buf[i - 1];
+	return val;
+}
+
+/**
+ * @brief Read the differences of the flash contents to a reference image.
+ *
+ * The included layout regions are read in chunks and compared block by
+ * block to the reference. Only runs of differing blocks are passed to
+ * the callback, so the caller never needs to hold a full image of the
+ * flash contents.
+ *
+ * @param flashctx  The context of the flash chip to read from.
+ * @param reference The expected flash contents, of full flash size.
+ * @param len       The length of the reference.
+ * @param callback  Called with the offset, data and length of each run of
+ *                  differing blocks, in ascending order. A non-zero
+ *                  return value aborts the read.
+ * @param data      Passed through to the callback.
+ *
+ * @return 0 on success,
+ *         2 if the reference's length doesn't match the flash size,
+ *         1 on any other error.
+ */
+int flashrom_image_read_delta(struct flashrom_flashctx *const flashctx, const void *const reference,
+			      const size_t len, flashrom_delta_callback *const callback, void *const data)
+{
+	const struct flashrom_layout *const layout = get_layout(flashctx);
+	const uint8_t *const ref = reference;
+	size_t i, differing = 0;
+	int ret = 1;
+
+	if (len != flashctx->chip->total_size * 1024)
+		return 2;
+
+	uint8_t *const buf = malloc(DELTA_READ_SIZE);
+	if (!buf) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+
+	if (prepare_flash_access(flashctx, true, false, false, false)) {
+		free(buf);
+		return 1;
+	}
+
+	msg_cinfo("Reading differences to reference... ");
+	for (i = 0; i < layout->num_entries; ++i) {
+		const struct romentry *const entry = &layout->entries[i];
+		if (!entry->included)
+			continue;
+
+		chipoff_t start;
+		for (start = entry->start; start <= entry->end; start += DELTA_READ_SIZE) {
+			const chipsize_t chunk = min(DELTA_READ_SIZE, entry->end - start + 1);
+			if (flashctx->chip->read(flashctx, buf, start, chunk)) {
+				msg_cerr("Read operation failed!\n");
+				goto _finalize_ret;
+			}
+
+			/* Find runs of differing blocks within the chunk. */
+			chipsize_t off = 0;
+			while (off < chunk) {
+				chipsize_t block = min(DELTA_BLOCK_SIZE, chunk - off);
+				if (!memcmp(buf + off, ref + start + off, block)) {
+					off += block;
+					continue;
+				}
+				const chipsize_t run_start = off;
+				do {
+					off += block;
+					block = min(DELTA_BLOCK_SIZE, chunk - off);
+				} while (off < chunk && memcmp(buf + off, ref + start + off, block));
+
+				differing += off - run_start;
+				if (callback(data, start + run_start, buf + run_start, off - run_start))
+					goto _finalize_ret;
+			}
+		}
+	}
+	msg_cinfo("done, %zu bytes differ.\n", differing);
+	ret = 0;
+
+_finalize_ret:
+	if (ret)
+		msg_cinfo("FAILED.\n");
+	finalize_flash_access(flashctx);
+	free(buf);
+	return ret;
+}
+
+/* Reads the reference image, padded with erased bytes like a short image would be. */
+static uint8_t *read_reference(const struct flashctx *const flash, const char *const reffile)
+{
+	const size_t flash_size = flash->chip->total_size * 1024;
+
+	uint8_t *const ref = malloc(flash_size);
+	if (!ref) {
+		msg_gerr("Out of memory!\n");
+		return NULL;
+	}
+	memset(ref, 0xff, flash_size);
+	if (read_buf_from_file(ref, flash_size, reffile)) {
+		free(ref);
+		return NULL;
+	}
+	return ref;
+}
+
+static int write_delta_record(void *const data, const size_t offset, const void *const buf, const size_t len)
+{
+	FILE *const delta = data;
+	uint8_t rec[8];
+
+	delta_put_le(rec, offset, 4);
+	delta_put_le(rec + 4, len, 4);
+	if (fwrite(rec, 1, sizeof(rec), delta) != sizeof(rec) || fwrite(buf, 1, len, delta) != len) {
+		msg_gerr("Error: writing delta failed: %s\n", strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+/* Writes the included layout regions, so that a restore doesn't touch anything else. */
+static int write_delta_ranges(const struct flashctx *const flash, FILE *const delta)
+{
+	const struct flashrom_layout *const layout = get_layout(flash);
+	uint8_t range[8];
+	size_t i;
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		const struct romentry *const entry = &layout->entries[i];
+		if (!entry->included)
+			continue;
+		delta_put_le(range, entry->start, 4);
+		delta_put_le(range + 4, entry->end, 4);
+		if (fwrite(range, 1, sizeof(range), delta) != sizeof(range)) {
+			msg_gerr("Error: writing delta failed: %s\n", strerror(errno));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int do_read_delta(struct flashctx *const flash, const char *const filename, const char *const reffile)
+{
+#ifdef __LIBPAYLOAD__
+	msg_gerr("Error: No file I/O support in libpayload\n");
+	return 1;
+#else
+	const struct flashrom_layout *const layout = get_layout(flash);
+	const size_t flash_size = flash->chip->total_size * 1024;
+	uint8_t header[DELTA_HEADER_LEN];
+	size_t i, ranges = 0;
+	int ret = 1;
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		if (layout->entries[i].included)
+			++ranges;
+	}
+	if (ranges > DELTA_MAX_RANGES) {
+		msg_gerr("Error: A delta can't cover more than %d regions.\n", DELTA_MAX_RANGES);
+		return 1;
+	}
+
+	uint8_t *const ref = read_reference(flash, reffile);
+	if (!ref)
+		return 1;
+
+	FILE *const delta = fopen(filename, "wb");
+	if (!delta) {
+		msg_gerr("Error: opening file \"%s\" failed: %s\n", filename, strerror(errno));
+		goto _free_ret;
+	}
+
+	memcpy(header, DELTA_SIGNATURE, 8);
+	delta_put_le(header + 8, flash_size, 4);
+	delta_put_le(header + 12, DELTA_BLOCK_SIZE, 4);
+	delta_put_le(header + 16, fnv1a_64(ref, flash_size), 8);
+	delta_put_le(header + 24, ranges, 4);
+	if (fwrite(header, 1, sizeof(header), delta) != sizeof(header)) {
+		msg_gerr("Error: writing delta failed: %s\n", strerror(errno));
+		(void)fclose(delta);
+		goto _free_ret;
+	}
+	if (write_delta_ranges(flash, delta)) {
+		(void)fclose(delta);
+		goto _free_ret;
+	}
+
+	ret = flashrom_image_read_delta(flash, ref, flash_size, write_delta_record, delta);
+
+	if (fclose(delta)) {
+		msg_gerr("Error: closing file \"%s\" failed: %s\n", filename, strerror(errno));
+		ret = 1;
+	}
+_free_ret:
+	free(ref);
+	return ret;
+#endif
+}
+
+/* Reads the ranges that a delta was read from into a newly allocated layout. */
+static struct delta_layout *read_delta_ranges(FILE *const delta, const char *const filename,
+					      const size_t ranges, const size_t flash_size)
+{
+	uint8_t range[8];
+	size_t i;
+
+	if (ranges == 0 || ranges > DELTA_MAX_RANGES) {
+		msg_gerr("Error: Delta \"%s\" is corrupt.\n", filename);
+		return NULL;
+	}
+	struct delta_layout *const covered = malloc(sizeof(*covered) + ranges * sizeof(covered->entries[0]));
+	if (!covered) {
+		msg_gerr("Out of memory!\n");
+		return NULL;
+	}
+	covered->base.entries = covered->entries;
+	covered->base.num_entries = ranges;
+
+	for (i = 0; i < ranges; ++i) {
+		struct romentry *const entry = &covered->entries[i];
+		if (fread(range, 1, sizeof(range), delta) != sizeof(range)) {
+			msg_gerr("Error: Delta \"%s\" is truncated.\n", filename);
+			goto _free_ret;
+		}
+		entry->start = delta_get_le(range, 4);
+		entry->end = delta_get_le(range + 4, 4);
+		if (entry->start > entry->end || entry->end >= flash_size) {
+			msg_gerr("Error: Delta \"%s\" is corrupt.\n", filename);
+			goto _free_ret;
+		}
+		entry->included = true;
+		snprintf(entry->name, sizeof(entry->name), "delta range %zu", i);
+		msg_cinfo("Delta covers 0x%06x-0x%06x.\n", entry->start, entry->end);
+	}
+	return covered;
+
+_free_ret:
+	free(covered);
+	return NULL;
+}
+
+/*
+ * Reconstructs a full image from the reference and a delta file. The ranges
+ * that the delta was read from are returned in `covered`.
+ */
+static uint8_t *read_delta_image(const struct flashctx *const flash, const char *const filename,
+				 const char *const reffile, struct delta_layout **const covered)
+{
+#ifdef __LIBPAYLOAD__
+	msg_gerr("Error: No file I/O support in libpayload\n");
+	return NULL;
+#else
+	const size_t flash_size = flash->chip->total_size * 1024;
+	uint8_t header[DELTA_HEADER_LEN], rec[8];
+	size_t n;
+
+	*covered = NULL;
+
+	uint8_t *const image = read_reference(flash, reffile);
+	if (!image)
+		return NULL;
+
+	FILE *const delta = fopen(filename, "rb");
+	if (!delta) {
+		msg_gerr("Error: opening file \"%s\" failed: %s\n", filename, strerror(errno));
+		goto _free_ret;
+	}
+
+	if (fread(header, 1, sizeof(header), delta) != sizeof(header) ||
+	    memcmp(header, DELTA_SIGNATURE, 8)) {
+		msg_gerr("Error: \"%s\" is not a delta image.\n", filename);
+		goto _close_ret;
+	}
+	if (delta_get_le(header + 8, 4) != flash_size) {
+		msg_gerr("Error: Delta was taken from a %u B flash chip, but this one has %zu B.\n",
+			 (unsigned int)delta_get_le(header + 8, 4), flash_size);
+		goto _close_ret;
+	}
+	if (delta_get_le(header + 16, 8) != fnv1a_64(image, flash_size)) {
+		msg_gerr("Error: Delta \"%s\" wasn't taken against reference \"%s\".\n", filename, reffile);
+		goto _close_ret;
+	}
+	*covered = read_delta_ranges(delta, filename, delta_get_le(header + 24, 4), flash_size);
+	if (!*covered)
+		goto _close_ret;
+
+	while ((n = fread(rec, 1, sizeof(rec), delta)) == sizeof(rec)) {
+		const uint32_t offset = delta_get_le(rec, 4);
+		const uint32_t len = delta_get_le(rec + 4, 4);
+		if (offset >= flash_size || len > flash_size - offset ||
+		    fread(image + offset, 1, len, delta) != len) {
+			msg_gerr("Error: Delta \"%s\" is corrupt.\n", filename);
+			goto _close_ret;
+		}
+	}
+	if (n) {
+		msg_gerr("Error: Delta \"%s\" is truncated.\n", filename);
+		goto _close_ret;
+	}
+
+	(void)fclose(delta);
+	return image;
+
+_close_ret:
+	(void)fclose(delta);
+_free_ret:
+	free(*covered);
+	*covered = NULL;
+	free(image);
+	return NULL;
+#endif
+}
+
+/*
+ * Writes or verifies the image reconstructed from a delta. Outside the ranges
+ * that were read for the delta, the image holds only the reference, so these
+ * ranges replace the layout, whatever regions are included.
+ */
+static int restore_delta(struct flashctx *const flash, const char *const filename, const char *const reffile,
+			 const bool write)
+{
+	const size_t flash_size = flash->chip->total_size * 1024;
+	struct delta_layout *covered;
+
+	uint8_t *const newcontents = read_delta_image(flash, filename, reffile, &covered);
+	if (!newcontents)
+		return 1;
+
+	const struct flashrom_layout *const saved_layout = flash->layout;
+	const bool saved_verify_all = flash->flags.verify_whole_chip;
+	flash->layout = &covered->base;
+	flash->flags.verify_whole_chip = false;
+
+	const int ret = write ? flashrom_image_write(flash, newcontents, flash_size)
+			      : flashrom_image_verify(flash, newcontents, flash_size);
+
+	flash->layout = saved_layout;
+	flash->flags.verify_whole_chip = saved_verify_all;
+	free(covered);
+	free(newcontents);
+	return ret;
+}
+
+int do_write_delta(struct flashctx *const flash, const char *const filename, const char *const reffile)
+{
+	return restore_delta(flash, filename, reffile, true);
+}
+
+int do_verify_delta(struct flashctx *const flash, const char *const filename, const char *const reffile)
+{
+	return restore_delta(flash, filename, reffile, false);
+}
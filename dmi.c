@@ -481,4 +481,21 @@ int dmi_match(const char *pattern)
 	return 0;
 }
 
+/* Hashes all DMI strings that identify the system, 0 if there is no DMI support. */
+uint64_t dmi_fingerprint(void)
+{
+	uint64_t hash = 0;
+	int i;
+
+	if (!has_dmi_support)
+		return 0;
+
+	for (i = 0; i < ARRAY_SIZE(dmi_strings); i++) {
+		const char *const value = dmi_strings[i].value ? dmi_strings[i].value : "";
+		/* Include the terminator to keep adjacent strings apart. */
+		hash = hash * 31 + fnv1a_64((const uint8_t *)value, strlen(value) + 1);
+	}
+	return hash;
+}
+
 #endif // defined(__i386__) || defined(__x86_64__)
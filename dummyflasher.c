@@ -22,18 +22,27 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <errno.h>
+#include <time.h>
+#include <sys/time.h>
 #include "flash.h"
 #include "chipdrivers.h"
 #include "programmer.h"
 
 /* Remove the #define below if you don't want SPI flash chip emulation. */
 #define EMULATE_SPI_CHIP 1
+/* Remove the #define below if you don't want parallel flash chip emulation. */
+#define EMULATE_PARALLEL_CHIP 1
 
 #if EMULATE_SPI_CHIP
 #define EMULATE_CHIP 1
 #include "spi.h"
 #endif
 
+#if EMULATE_PARALLEL_CHIP
+#define EMULATE_CHIP 1
+#include "flashchips.h"
+#endif
+
 #if EMULATE_CHIP
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -47,6 +56,10 @@ enum emu_chip {
 	EMULATE_SST_SST25VF040_REMS,
 	EMULATE_SST_SST25VF032B,
 	EMULATE_MACRONIX_MX25L6436,
+	EMULATE_WINBOND_W25Q128FW,
+	EMULATE_WINBOND_W25M512JV,
+	EMULATE_AMD_AM29LV040B,
+	EMULATE_SST_SST49LF040B,
 };
 static enum emu_chip emu_chip = EMULATE_NONE;
 static char *emu_persistent_image = NULL;
@@ -64,6 +77,42 @@ unsigned char spi_ignorelist[256];
 int spi_blacklist_size = 0;
 int spi_ignorelist_size = 0;
 static uint8_t emu_status = 0;
+static uint8_t emu_status2 = 0;
+static bool emu_qpi_mode = false;
+/* Percentage of page programs that leave a byte unprogrammed. */
+static unsigned int emu_program_faults = 0;
+static unsigned int emu_program_faults_injected = 0;
+/* Percentage of read commands that return a flipped bit. */
+static unsigned int emu_read_flips = 0;
+static unsigned int emu_read_flips_injected = 0;
+/* Stacked-die chips: each die has its own status register and stays busy
+   for a while after erase and program commands. Times are in microseconds
+   since init, the busy times are scaled down from the datasheet ones. */
+#define EMU_MAX_DIES		2
+#define EMU_DIE_PROGRAM_US	100
+#define EMU_DIE_SE_US		2000
+#define EMU_DIE_BE_US		10000
+static unsigned int emu_dies = 0;
+static unsigned int emu_selected_die = 0;
+static uint8_t emu_die_status[EMU_MAX_DIES];
+static uint64_t emu_die_busy_until[EMU_MAX_DIES];
+static uint64_t emu_die_busy_us[EMU_MAX_DIES];
+static uint64_t emu_dies_overlap_us = 0;
+/* Time in microseconds an erase keeps the chip busy, 0 for instant erases.
+   Running erases can be suspended with 0x75 and resumed with 0x7a, but
+   only make progress if they run for a while between two suspends. */
+#define EMU_ERASE_RESUME_US	100
+static unsigned int emu_erase_time = 0;
+static uint64_t emu_erase_until = 0;	/* end of the running erase */
+static uint64_t emu_erase_resumed = 0;	/* start of the running erase or its last resume */
+static uint64_t emu_erase_left = 0;	/* remaining time of the suspended erase */
+static unsigned int emu_erase_start = 0;
+static unsigned int emu_erase_len = 0;
+static unsigned int emu_erase_suspends = 0;
+static unsigned int emu_suspended_reads = 0;
+static unsigned long emu_suspended_read_bytes = 0;
+/* Programs and erases the W25Q128FW ignored because of its block protection. */
+static unsigned int emu_protected_writes = 0;
 
 /* A legit complete SFDP table based on the MX25L6436E (rev. 1.8) datasheet. */
 static const uint8_t sfdp_table[] = {
@@ -91,11 +140,67 @@ static const uint8_t sfdp_table[] = {
 	0xFF, 0xFF, 0xFF, 0xFF, // @0x54: Macronix parameter table end
 };
 
+#endif
+#if EMULATE_PARALLEL_CHIP
+/* Command state machine of AMD-style (JEDEC) parallel chips. */
+enum emu_jedec_state {
+	JEDEC_STATE_READ,
+	JEDEC_STATE_UNLOCK1,		/* 0xAA was written to 0x555. */
+	JEDEC_STATE_UNLOCK2,		/* 0x55 was written to 0x2AA. */
+	JEDEC_STATE_AUTOSELECT,
+	JEDEC_STATE_PROGRAM,
+	JEDEC_STATE_ERASE_SETUP,
+	JEDEC_STATE_ERASE_UNLOCK1,
+	JEDEC_STATE_ERASE_UNLOCK2,
+	JEDEC_STATE_BYPASS,
+	JEDEC_STATE_BYPASS_PROGRAM,
+	JEDEC_STATE_BYPASS_RESET,
+};
+static enum emu_jedec_state emu_jedec_state = JEDEC_STATE_READ;
+static unsigned int emu_jedec_sector_size = 0;
+static unsigned int emu_jedec_block_size = 0;	/* 0x50 erase, 0 if unsupported */
+/* Block lock registers of the SST49LF040B, one per 64 kB block, 4 MB below
+   the flash. Programs and erases of write locked blocks are ignored. */
+#define EMU_FWH_LOCK_BLOCK	(64 * 1024)
+#define EMU_FWH_WRITE_LOCK	(1 << 0)
+#define EMU_FWH_LOCKDOWN	(1 << 1)
+static uint8_t emu_fwh_locks[8];
+static unsigned int emu_fwh_lock_reads = 0;
+static unsigned int emu_fwh_lock_writes = 0;
+static unsigned int emu_fwh_locked_writes = 0;
 #endif
 #endif
 
 static unsigned int spi_write_256_chunksize = 256;
 
+/* Number of SPI commands sent per opcode, summarized on shutdown. */
+static unsigned int spi_command_count[256];
+/* SPI clock cycles those commands took with their I/O widths. */
+static unsigned long spi_bus_clocks;
+
+/* Number of chip read and write cycles on the parallel/LPC/FWH bus, summarized on shutdown. */
+static unsigned long par_read_cycles;
+static unsigned long par_write_cycles;
+
+/* CPU and wall clock time at init, to tell how busy delays keep the CPU. */
+static clock_t init_cpu_time;
+static struct timeval init_wall_time;
+
+/* CPU and wall clock time per kind of operation, see dummy_switch_op(). */
+enum dummy_op {
+	DUMMY_OP_NONE = -1,
+	DUMMY_OP_READ,
+	DUMMY_OP_ERASE,
+	DUMMY_OP_WRITE,
+	DUMMY_OPS
+};
+static const char *const dummy_op_names[DUMMY_OPS] = { "Reading", "Erasing", "Writing" };
+static enum dummy_op dummy_op = DUMMY_OP_NONE;
+static clock_t dummy_op_cpu_start;
+static struct timeval dummy_op_wall_start;
+static clock_t dummy_op_cpu[DUMMY_OPS];
+static unsigned long long dummy_op_wall_us[DUMMY_OPS];
+
 static int dummy_spi_send_command(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt,
 				  const unsigned char *writearr, unsigned char *readarr);
 static int dummy_spi_write_256(struct flashctx *flash, const uint8_t *buf,
@@ -109,9 +214,9 @@ static uint16_t dummy_chip_readw(const struct flashctx *flash, const chipaddr ad
 static uint32_t dummy_chip_readl(const struct flashctx *flash, const chipaddr addr);
 static void dummy_chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len);
 
-static const struct spi_master spi_master_dummyflasher = {
+static struct spi_master spi_master_dummyflasher = {
 	.type		= SPI_CONTROLLER_DUMMY,
-	.features	= SPI_MASTER_4BA,
+	.features	= SPI_MASTER_4BA | SPI_MASTER_QUAD_IN | SPI_MASTER_QPI,
 	.max_data_read	= MAX_DATA_READ_UNLIMITED,
 	.max_data_write	= MAX_DATA_UNSPECIFIED,
 	.command	= dummy_spi_send_command,
@@ -134,9 +239,165 @@ static const struct par_master par_master_dummy = {
 
 enum chipbustype dummy_buses_supported = BUS_NONE;
 
+static void dummy_print_spi_commands(void)
+{
+	unsigned int i, total = 0;
+
+	for (i = 0; i < ARRAY_SIZE(spi_command_count); i++)
+		total += spi_command_count[i];
+	if (!total)
+		return;
+
+	msg_pdbg("%u SPI commands sent:", total);
+	for (i = 0; i < ARRAY_SIZE(spi_command_count); i++) {
+		if (spi_command_count[i])
+			msg_pdbg(" 0x%02x: %u", i, spi_command_count[i]);
+	}
+	msg_pdbg("\n");
+	msg_pdbg("SPI commands took %lu bus clocks.\n", spi_bus_clocks);
+	memset(spi_command_count, 0, sizeof(spi_command_count));
+	spi_bus_clocks = 0;
+}
+
+static void dummy_print_par_cycles(void)
+{
+	if (!par_read_cycles && !par_write_cycles)
+		return;
+
+	msg_pdbg("%lu chip bus cycles: %lu reads, %lu writes.\n",
+		 par_read_cycles + par_write_cycles, par_read_cycles, par_write_cycles);
+	par_read_cycles = 0;
+	par_write_cycles = 0;
+}
+
+/*
+ * Charges the time since the last switch to the current operation and makes
+ * `op` the current one. Everything in between, like status polls and delays,
+ * counts towards the operation of the last read, erase or program command.
+ */
+static void dummy_switch_op(const enum dummy_op op)
+{
+	struct timeval now;
+	const clock_t cpu = clock();
+
+	gettimeofday(&now, NULL);
+	if (dummy_op != DUMMY_OP_NONE) {
+		dummy_op_cpu[dummy_op] += cpu - dummy_op_cpu_start;
+		dummy_op_wall_us[dummy_op] += (now.tv_sec - dummy_op_wall_start.tv_sec) * 1000000LL +
+					      (now.tv_usec - dummy_op_wall_start.tv_usec);
+	}
+	dummy_op = op;
+	dummy_op_cpu_start = cpu;
+	dummy_op_wall_start = now;
+}
+
+/* Called for every command, so only look at the clocks when the operation changes. */
+static void dummy_start_op(const enum dummy_op op)
+{
+	if (op != DUMMY_OP_NONE && op != dummy_op)
+		dummy_switch_op(op);
+}
+
+static enum dummy_op dummy_spi_op(const unsigned char opcode)
+{
+	switch (opcode) {
+	case JEDEC_READ:
+	case JEDEC_FAST_READ:
+	case JEDEC_READ_4BA:
+	case JEDEC_READ_4BA_FAST:
+		return DUMMY_OP_READ;
+	case JEDEC_SE:
+	case JEDEC_BE_50:
+	case JEDEC_BE_52:
+	case JEDEC_BE_81:
+	case JEDEC_BE_C4:
+	case JEDEC_BE_D7:
+	case JEDEC_BE_D8:
+	case JEDEC_CE_60:
+	case JEDEC_CE_62:
+	case JEDEC_CE_C7:
+	case 0x21:	/* 4BA sector erase */
+	case 0xdc:	/* 4BA block erase */
+		return DUMMY_OP_ERASE;
+	case JEDEC_BYTE_PROGRAM:
+	case JEDEC_BYTE_PROGRAM_4BA:
+	case JEDEC_QUAD_PAGE_PROGRAM:
+	case JEDEC_AAI_WORD_PROGRAM:
+		return DUMMY_OP_WRITE;
+	default:
+		return DUMMY_OP_NONE;
+	}
+}
+
+static void dummy_print_cpu_time(void)
+{
+	struct timeval now;
+	unsigned int i;
+
+	dummy_switch_op(DUMMY_OP_NONE);
+	for (i = 0; i < DUMMY_OPS; ++i) {
+		if (!dummy_op_wall_us[i])
+			continue;
+		const unsigned long cpu_ms = (unsigned long)dummy_op_cpu[i] * 1000 / CLOCKS_PER_SEC;
+		const unsigned long wall_ms = dummy_op_wall_us[i] / 1000;
+		msg_pdbg("%s used %lu ms of CPU time in %lu ms (%lu%%).\n", dummy_op_names[i],
+			 cpu_ms, wall_ms, wall_ms ? cpu_ms * 100 / wall_ms : 0);
+	}
+	memset(dummy_op_cpu, 0, sizeof(dummy_op_cpu));
+	memset(dummy_op_wall_us, 0, sizeof(dummy_op_wall_us));
+
+	const clock_t cpu = clock() - init_cpu_time;
+	gettimeofday(&now, NULL);
+	const unsigned long cpu_ms = (unsigned long)cpu * 1000 / CLOCKS_PER_SEC;
+	const unsigned long wall_ms = (now.tv_sec - init_wall_time.tv_sec) * 1000 +
+				      (now.tv_usec - init_wall_time.tv_usec) / 1000;
+	msg_pdbg("Used %lu ms of CPU time in %lu ms (%lu%%) in total.\n",
+		 cpu_ms, wall_ms, wall_ms ? cpu_ms * 100 / wall_ms : 0);
+}
+
 static int dummy_shutdown(void *data)
 {
+#if EMULATE_SPI_CHIP
+	unsigned int i;
+#endif
+
 	msg_pspew("%s\n", __func__);
+	dummy_print_spi_commands();
+	dummy_print_par_cycles();
+	dummy_print_cpu_time();
+#if EMULATE_SPI_CHIP
+	if (emu_program_faults_injected)
+		msg_pdbg("Injected %u page program faults.\n", emu_program_faults_injected);
+	emu_program_faults_injected = 0;
+	if (emu_read_flips_injected)
+		msg_pdbg("Injected %u read bit flips.\n", emu_read_flips_injected);
+	emu_read_flips_injected = 0;
+	if (emu_erase_suspends)
+		msg_pdbg("Suspended erases %u times, read %lu bytes in %u reads while suspended.\n",
+			 emu_erase_suspends, emu_suspended_read_bytes, emu_suspended_reads);
+	emu_erase_suspends = 0;
+	emu_suspended_reads = 0;
+	emu_suspended_read_bytes = 0;
+	if (emu_protected_writes)
+		msg_pdbg("Ignored %u programs and erases of protected blocks.\n", emu_protected_writes);
+	emu_protected_writes = 0;
+	if (emu_dies) {
+		for (i = 0; i < emu_dies; ++i)
+			msg_pdbg("Die %u was busy for %lu ms.\n", i, (unsigned long)(emu_die_busy_us[i] / 1000));
+		msg_pdbg("Dies were busy at the same time for %lu ms.\n",
+			 (unsigned long)(emu_dies_overlap_us / 1000));
+	}
+#endif
+#if EMULATE_PARALLEL_CHIP
+	if (emu_fwh_lock_reads || emu_fwh_lock_writes)
+		msg_pdbg("Lock registers were read %u times and written %u times.\n",
+			 emu_fwh_lock_reads, emu_fwh_lock_writes);
+	if (emu_fwh_locked_writes)
+		msg_pdbg("Ignored %u programs and erases of locked blocks.\n", emu_fwh_locked_writes);
+	emu_fwh_lock_reads = 0;
+	emu_fwh_lock_writes = 0;
+	emu_fwh_locked_writes = 0;
+#endif
 #if EMULATE_CHIP
 	if (emu_chip != EMULATE_NONE) {
 		if (emu_persistent_image) {
@@ -165,6 +426,10 @@ int dummy_init(void)
 
 	msg_pspew("%s\n", __func__);
 
+	init_cpu_time = clock();
+	gettimeofday(&init_wall_time, NULL);
+	dummy_op = DUMMY_OP_NONE;
+
 	bustext = extract_programmer_param("bus");
 	msg_pdbg("Requested buses are: %s\n", bustext ? bustext : "default");
 	if (!bustext)
@@ -203,6 +468,22 @@ int dummy_init(void)
 		}
 	}
 
+	spi_master_dummyflasher.features = SPI_MASTER_4BA | SPI_MASTER_QUAD_IN | SPI_MASTER_QPI;
+	tmp = extract_programmer_param("spi_io");
+	if (tmp) {
+		if (!strcmp(tmp, "single")) {
+			spi_master_dummyflasher.features &= ~(SPI_MASTER_QUAD_IN | SPI_MASTER_QPI);
+		} else if (!strcmp(tmp, "quad")) {
+			spi_master_dummyflasher.features &= ~SPI_MASTER_QPI;
+		} else if (strcmp(tmp, "qpi")) {
+			msg_perr("Invalid spi_io value \"%s\", use single, quad or qpi.\n", tmp);
+			free(tmp);
+			return 1;
+		}
+		msg_pdbg("Limiting SPI I/O to %s.\n", tmp);
+		free(tmp);
+	}
+
 	tmp = extract_programmer_param("spi_blacklist");
 	if (tmp) {
 		i = strlen(tmp);
@@ -335,6 +616,64 @@ int dummy_init(void)
 		msg_pdbg("Emulating Macronix MX25L6436 SPI flash chip (RDID, "
 			 "SFDP)\n");
 	}
+	if (!strcmp(tmp, "W25Q128FW")) {
+		emu_chip = EMULATE_WINBOND_W25Q128FW;
+		emu_chip_size = 16 * 1024 * 1024;
+		emu_max_byteprogram_size = 256;
+		emu_max_aai_size = 0;
+		emu_jedec_se_size = 4 * 1024;
+		emu_jedec_be_52_size = 32 * 1024;
+		emu_jedec_be_d8_size = 64 * 1024;
+		emu_jedec_ce_60_size = emu_chip_size;
+		emu_jedec_ce_c7_size = emu_chip_size;
+		/* The QE bit is set in the factory. */
+		emu_status2 = SPI_SR2_QE;
+		emu_qpi_mode = false;
+		msg_pdbg("Emulating Winbond W25Q128FW SPI flash chip (RDID, "
+			 "quad page program, QPI)\n");
+	}
+	if (!strcmp(tmp, "W25M512JV")) {
+		emu_chip = EMULATE_WINBOND_W25M512JV;
+		emu_chip_size = 64 * 1024 * 1024;
+		emu_max_byteprogram_size = 256;
+		emu_max_aai_size = 0;
+		/* Only the native 4BA instructions are emulated, per die. */
+		emu_jedec_se_size = 0;
+		emu_jedec_be_52_size = 0;
+		emu_jedec_be_d8_size = 0;
+		emu_jedec_ce_60_size = 0;
+		emu_jedec_ce_c7_size = 0;
+		emu_dies = 2;
+		emu_selected_die = 0;
+		memset(emu_die_status, 0, sizeof(emu_die_status));
+		memset(emu_die_busy_until, 0, sizeof(emu_die_busy_until));
+		memset(emu_die_busy_us, 0, sizeof(emu_die_busy_us));
+		emu_dies_overlap_us = 0;
+		msg_pdbg("Emulating Winbond W25M512JV SPI flash chip (RDID, "
+			 "two stacked dies)\n");
+	}
+#endif
+#if EMULATE_PARALLEL_CHIP
+	if (!strcmp(tmp, "Am29LV040B")) {
+		emu_chip = EMULATE_AMD_AM29LV040B;
+		emu_chip_size = 512 * 1024;
+		emu_jedec_sector_size = 64 * 1024;
+		emu_jedec_block_size = 0;
+		emu_jedec_state = JEDEC_STATE_READ;
+		msg_pdbg("Emulating AMD Am29LV040B parallel flash chip (byte "
+			 "write, unlock bypass)\n");
+	}
+	if (!strcmp(tmp, "SST49LF040B")) {
+		emu_chip = EMULATE_SST_SST49LF040B;
+		emu_chip_size = 512 * 1024;
+		emu_jedec_sector_size = 4 * 1024;
+		emu_jedec_block_size = 64 * 1024;
+		emu_jedec_state = JEDEC_STATE_READ;
+		/* All blocks are write locked after reset. */
+		memset(emu_fwh_locks, EMU_FWH_WRITE_LOCK, sizeof(emu_fwh_locks));
+		msg_pdbg("Emulating SST SST49LF040B LPC flash chip (byte "
+			 "write, block lock registers)\n");
+	}
 #endif
 	if (emu_chip == EMULATE_NONE) {
 		msg_perr("Invalid chip specified for emulation: %s\n", tmp);
@@ -363,6 +702,91 @@ int dummy_init(void)
 		msg_pdbg("Initial status register is set to 0x%02x.\n",
 			 emu_status);
 	}
+
+	status = extract_programmer_param("spi_status2");
+	if (status) {
+		char *endptr;
+		errno = 0;
+		emu_status2 = strtoul(status, &endptr, 0);
+		if (errno != 0 || status == endptr) {
+			free(status);
+			msg_perr("Error: initial status register 2 specified, "
+				 "but the value could not be converted.\n");
+			return 1;
+		}
+		free(status);
+		msg_pdbg("Initial status register 2 is set to 0x%02x.\n",
+			 emu_status2);
+	}
+
+	tmp = extract_programmer_param("spi_program_faults");
+	if (tmp) {
+		char *endptr;
+		errno = 0;
+		emu_program_faults = strtoul(tmp, &endptr, 0);
+		if (errno != 0 || tmp == endptr || *endptr != '\0' || emu_program_faults > 100) {
+			msg_perr("Error: spi_program_faults must be a percentage from 0 to 100.\n");
+			free(tmp);
+			return 1;
+		}
+		free(tmp);
+		msg_pdbg("Corrupting %u%% of programmed pages.\n", emu_program_faults);
+	}
+
+	tmp = extract_programmer_param("spi_read_flips");
+	if (tmp) {
+		char *endptr;
+		errno = 0;
+		emu_read_flips = strtoul(tmp, &endptr, 0);
+		if (errno != 0 || tmp == endptr || *endptr != '\0' || emu_read_flips > 100) {
+			msg_perr("Error: spi_read_flips must be a percentage from 0 to 100.\n");
+			free(tmp);
+			return 1;
+		}
+		free(tmp);
+		msg_pdbg("Flipping a bit in %u%% of reads.\n", emu_read_flips);
+	}
+
+	tmp = extract_programmer_param("spi_erase_time");
+	if (tmp) {
+		char *endptr;
+		errno = 0;
+		emu_erase_time = strtoul(tmp, &endptr, 0);
+		if (errno != 0 || tmp == endptr || *endptr != '\0') {
+			msg_perr("Error: spi_erase_time must be a number of microseconds.\n");
+			free(tmp);
+			return 1;
+		}
+		free(tmp);
+		msg_pdbg("Erases take %u us.\n", emu_erase_time);
+	}
+#endif
+#if EMULATE_PARALLEL_CHIP
+	tmp = extract_programmer_param("fwh_locks");
+	if (tmp) {
+		i = strlen(tmp);
+		if (emu_chip != EMULATE_SST_SST49LF040B || i > 2 * (int)sizeof(emu_fwh_locks) || (i % 2)) {
+			msg_perr("Error: fwh_locks needs emulate=SST49LF040B and up to %zu "
+				 "hex bytes, one per 64 kB block.\n", sizeof(emu_fwh_locks));
+			free(tmp);
+			return 1;
+		}
+		for (i = 0; tmp[i]; i += 2) {
+			unsigned int lock;
+			if (!isxdigit((unsigned char)tmp[i]) || !isxdigit((unsigned char)tmp[i + 1])) {
+				msg_perr("Invalid char in fwh_locks\n");
+				free(tmp);
+				return 1;
+			}
+			sscanf(tmp + i, "%2x", &lock);
+			emu_fwh_locks[i / 2] = lock & 0x07;
+		}
+		free(tmp);
+		msg_pdbg("Initial lock registers are");
+		for (i = 0; i < (int)sizeof(emu_fwh_locks); i++)
+			msg_pdbg(" %02x", emu_fwh_locks[i]);
+		msg_pdbg("\n");
+	}
 #endif
 
 	msg_pdbg("Filling fake flash chip with 0xff, size %i\n", emu_chip_size);
@@ -416,19 +840,199 @@ void dummy_unmap(void *virt_addr, size_t len)
 	msg_pspew("%s: Unmapping 0x%zx bytes at %p\n", __func__, len, virt_addr);
 }
 
+#if EMULATE_PARALLEL_CHIP
+/* Returns the offset into the register space of the emulated FWH/LPC chip, or -1 if `addr` is outside. */
+static int emu_fwh_register(const chipaddr addr)
+{
+	const chipaddr base = 0xffffffff - emu_chip_size - 0x400000 + 1;
+
+	if (emu_chip != EMULATE_SST_SST49LF040B || addr < base || addr >= base + emu_chip_size)
+		return -1;
+	return addr - base;
+}
+
+static void emulate_fwh_register_write(uint8_t val, unsigned int offs)
+{
+	uint8_t *const lock = &emu_fwh_locks[offs / EMU_FWH_LOCK_BLOCK];
+
+	if (offs % EMU_FWH_LOCK_BLOCK != 2)
+		return;
+	emu_fwh_lock_writes++;
+	/* Lockdown freezes the register until the next reset. */
+	if (*lock & EMU_FWH_LOCKDOWN)
+		return;
+	*lock = val & 0x07;
+}
+
+static uint8_t emulate_fwh_register_read(unsigned int offs)
+{
+	if (offs % EMU_FWH_LOCK_BLOCK != 2)
+		return 0xff;
+	emu_fwh_lock_reads++;
+	return emu_fwh_locks[offs / EMU_FWH_LOCK_BLOCK];
+}
+
+/* Returns true if the emulated FWH/LPC chip ignores programs and erases of `len` bytes at `offs`. */
+static bool emu_fwh_locked(const unsigned int offs, const unsigned int len)
+{
+	unsigned int i;
+
+	if (emu_chip != EMULATE_SST_SST49LF040B)
+		return false;
+	for (i = offs / EMU_FWH_LOCK_BLOCK; i <= (offs + len - 1) / EMU_FWH_LOCK_BLOCK; ++i) {
+		if (emu_fwh_locks[i] & EMU_FWH_WRITE_LOCK) {
+			msg_pdbg("0x%06x-0x%06x is locked, ignoring the command.\n", offs, offs + len - 1);
+			emu_fwh_locked_writes++;
+			return true;
+		}
+	}
+	return false;
+}
+
+static void emulate_jedec_chip_write(uint8_t val, chipaddr addr)
+{
+	/* The chip only decodes the address lines it has, so it appears mirrored. */
+	const unsigned int offs = addr & (emu_chip_size - 1);
+	/* Command cycles only decode A10:A0. */
+	const unsigned int cmd_addr = offs & 0x7ff;
+
+	switch (emu_jedec_state) {
+	case JEDEC_STATE_PROGRAM:
+	case JEDEC_STATE_BYPASS_PROGRAM:
+		dummy_start_op(DUMMY_OP_WRITE);
+		/* Programming can only clear bits. */
+		if (!emu_fwh_locked(offs, 1))
+			flashchip_contents[offs] &= val;
+		emu_jedec_state = (emu_jedec_state == JEDEC_STATE_PROGRAM) ? JEDEC_STATE_READ
+									   : JEDEC_STATE_BYPASS;
+		return;
+	case JEDEC_STATE_BYPASS:
+		/* Only program and the unlock bypass reset are accepted. */
+		if (val == 0xa0)
+			emu_jedec_state = JEDEC_STATE_BYPASS_PROGRAM;
+		else if (val == 0x90)
+			emu_jedec_state = JEDEC_STATE_BYPASS_RESET;
+		return;
+	case JEDEC_STATE_BYPASS_RESET:
+		emu_jedec_state = (val == 0x00) ? JEDEC_STATE_READ : JEDEC_STATE_BYPASS;
+		return;
+	default:
+		break;
+	}
+
+	if (val == 0xf0) {
+		emu_jedec_state = JEDEC_STATE_READ;
+		return;
+	}
+
+	switch (emu_jedec_state) {
+	case JEDEC_STATE_READ:
+	case JEDEC_STATE_AUTOSELECT:
+		if (val == 0xaa && cmd_addr == 0x555)
+			emu_jedec_state = JEDEC_STATE_UNLOCK1;
+		break;
+	case JEDEC_STATE_UNLOCK1:
+		if (val == 0x55 && cmd_addr == 0x2aa)
+			emu_jedec_state = JEDEC_STATE_UNLOCK2;
+		else
+			emu_jedec_state = JEDEC_STATE_READ;
+		break;
+	case JEDEC_STATE_UNLOCK2:
+		emu_jedec_state = JEDEC_STATE_READ;
+		if (cmd_addr != 0x555)
+			break;
+		switch (val) {
+		case 0x20:
+			emu_jedec_state = JEDEC_STATE_BYPASS;
+			break;
+		case 0x80:
+			emu_jedec_state = JEDEC_STATE_ERASE_SETUP;
+			break;
+		case 0x90:
+			emu_jedec_state = JEDEC_STATE_AUTOSELECT;
+			break;
+		case 0xa0:
+			emu_jedec_state = JEDEC_STATE_PROGRAM;
+			break;
+		}
+		break;
+	case JEDEC_STATE_ERASE_SETUP:
+		if (val == 0xaa && cmd_addr == 0x555)
+			emu_jedec_state = JEDEC_STATE_ERASE_UNLOCK1;
+		else
+			emu_jedec_state = JEDEC_STATE_READ;
+		break;
+	case JEDEC_STATE_ERASE_UNLOCK1:
+		if (val == 0x55 && cmd_addr == 0x2aa)
+			emu_jedec_state = JEDEC_STATE_ERASE_UNLOCK2;
+		else
+			emu_jedec_state = JEDEC_STATE_READ;
+		break;
+	case JEDEC_STATE_ERASE_UNLOCK2:
+		dummy_start_op(DUMMY_OP_ERASE);
+		if (val == 0x10 && cmd_addr == 0x555) {
+			if (!emu_fwh_locked(0, emu_chip_size))
+				memset(flashchip_contents, 0xff, emu_chip_size);
+		} else if (val == 0x30) {
+			const unsigned int sector = offs & ~(emu_jedec_sector_size - 1);
+			if (!emu_fwh_locked(sector, emu_jedec_sector_size))
+				memset(flashchip_contents + sector, 0xff, emu_jedec_sector_size);
+		} else if (val == 0x50 && emu_jedec_block_size) {
+			const unsigned int block = offs & ~(emu_jedec_block_size - 1);
+			if (!emu_fwh_locked(block, emu_jedec_block_size))
+				memset(flashchip_contents + block, 0xff, emu_jedec_block_size);
+		}
+		emu_jedec_state = JEDEC_STATE_READ;
+		break;
+	default:
+		emu_jedec_state = JEDEC_STATE_READ;
+		break;
+	}
+}
+
+static uint8_t emulate_jedec_chip_read(chipaddr addr)
+{
+	const unsigned int offs = addr & (emu_chip_size - 1);
+
+	if (emu_jedec_state == JEDEC_STATE_AUTOSELECT) {
+		switch (offs & 0xff) {
+		case 0x00:
+			return emu_chip == EMULATE_SST_SST49LF040B ? SST_ID : AMD_ID;
+		case 0x01:
+			return emu_chip == EMULATE_SST_SST49LF040B ? SST_SST49LF040B : AMD_AM29LV040B;
+		default:
+			/* No sector is protected. */
+			return 0x00;
+		}
+	}
+	/* Operations complete immediately, so the toggle bits never toggle. */
+	return flashchip_contents[offs];
+}
+#endif
+
 static void dummy_chip_writeb(const struct flashctx *flash, uint8_t val, chipaddr addr)
 {
 	msg_pspew("%s: addr=0x%" PRIxPTR ", val=0x%02x\n", __func__, addr, val);
+	par_write_cycles++;
+#if EMULATE_PARALLEL_CHIP
+	const int reg = emu_fwh_register(addr);
+	if (reg >= 0)
+		emulate_fwh_register_write(val, reg);
+	else if (emu_chip == EMULATE_AMD_AM29LV040B || emu_chip == EMULATE_SST_SST49LF040B)
+		emulate_jedec_chip_write(val, addr);
+#endif
 }
 
 static void dummy_chip_writew(const struct flashctx *flash, uint16_t val, chipaddr addr)
 {
 	msg_pspew("%s: addr=0x%" PRIxPTR ", val=0x%04x\n", __func__, addr, val);
+	par_write_cycles++;
 }
 
 static void dummy_chip_writel(const struct flashctx *flash, uint32_t val, chipaddr addr)
 {
 	msg_pspew("%s: addr=0x%" PRIxPTR ", val=0x%08x\n", __func__, addr, val);
+	par_write_cycles++;
 }
 
 static void dummy_chip_writen(const struct flashctx *flash, const uint8_t *buf, chipaddr addr, size_t len)
@@ -440,10 +1044,31 @@ static void dummy_chip_writen(const struct flashctx *flash, const uint8_t *buf,
 			msg_pspew("\n");
 		msg_pspew("%02x ", buf[i]);
 	}
+	par_write_cycles += len;
+#if EMULATE_PARALLEL_CHIP
+	if (emu_chip == EMULATE_AMD_AM29LV040B || emu_chip == EMULATE_SST_SST49LF040B) {
+		for (i = 0; i < len; i++)
+			emulate_jedec_chip_write(buf[i], addr + i);
+	}
+#endif
 }
 
 static uint8_t dummy_chip_readb(const struct flashctx *flash, const chipaddr addr)
 {
+	par_read_cycles++;
+#if EMULATE_PARALLEL_CHIP
+	const int reg = emu_fwh_register(addr);
+	if (reg >= 0) {
+		const uint8_t val = emulate_fwh_register_read(reg);
+		msg_pspew("%s:  addr=0x%" PRIxPTR ", returning 0x%02x\n", __func__, addr, val);
+		return val;
+	}
+	if (emu_chip == EMULATE_AMD_AM29LV040B || emu_chip == EMULATE_SST_SST49LF040B) {
+		const uint8_t val = emulate_jedec_chip_read(addr);
+		msg_pspew("%s:  addr=0x%" PRIxPTR ", returning 0x%02x\n", __func__, addr, val);
+		return val;
+	}
+#endif
 	msg_pspew("%s:  addr=0x%" PRIxPTR ", returning 0xff\n", __func__, addr);
 	return 0xff;
 }
@@ -451,23 +1076,251 @@ static uint8_t dummy_chip_readb(const struct flashctx *flash, const chipaddr add
 static uint16_t dummy_chip_readw(const struct flashctx *flash, const chipaddr addr)
 {
 	msg_pspew("%s:  addr=0x%" PRIxPTR ", returning 0xffff\n", __func__, addr);
+	par_read_cycles++;
 	return 0xffff;
 }
 
 static uint32_t dummy_chip_readl(const struct flashctx *flash, const chipaddr addr)
 {
 	msg_pspew("%s:  addr=0x%" PRIxPTR ", returning 0xffffffff\n", __func__, addr);
+	par_read_cycles++;
 	return 0xffffffff;
 }
 
 static void dummy_chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len)
 {
+	dummy_start_op(DUMMY_OP_READ);
+	par_read_cycles += len;
+#if EMULATE_PARALLEL_CHIP
+	if (emu_chip == EMULATE_AMD_AM29LV040B || emu_chip == EMULATE_SST_SST49LF040B) {
+		size_t i;
+		msg_pspew("%s:  addr=0x%" PRIxPTR ", len=0x%zx, returning emulated contents\n",
+			  __func__, addr, len);
+		for (i = 0; i < len; i++)
+			buf[i] = emulate_jedec_chip_read(addr + i);
+		return;
+	}
+#endif
 	msg_pspew("%s:  addr=0x%" PRIxPTR ", len=0x%zx, returning array of 0xff\n", __func__, addr, len);
 	memset(buf, 0xff, len);
 	return;
 }
 
 #if EMULATE_SPI_CHIP
+static uint64_t emu_now_us(void)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return (now.tv_sec - init_wall_time.tv_sec) * 1000000LL + (now.tv_usec - init_wall_time.tv_usec);
+}
+
+static void emu_start_erase(const unsigned int offs, const unsigned int len)
+{
+	if (!emu_erase_time)
+		return;
+	emu_erase_start = offs;
+	emu_erase_len = len;
+	emu_erase_resumed = emu_now_us();
+	emu_erase_until = emu_erase_resumed + emu_erase_time;
+	emu_erase_left = 0;
+}
+
+/*
+ * Handles commands while an erase is running or suspended.
+ *
+ * Returns 0 if the command was handled and -1 if it should be executed
+ * as usual.
+ */
+static int emulate_erase_busy(unsigned int writecnt, unsigned int readcnt,
+			      const unsigned char *writearr, unsigned char *readarr)
+{
+	const uint64_t now = emu_now_us();
+	unsigned int offs;
+
+	if (now < emu_erase_until) {
+		switch (writearr[0]) {
+		case JEDEC_RDSR:
+			memset(readarr, emu_status | SPI_SR_WIP, readcnt);
+			return 0;
+		case JEDEC_ERASE_SUSPEND:
+			/* Suspending too early throws away the progress since the last resume. */
+			if (now - emu_erase_resumed < EMU_ERASE_RESUME_US)
+				emu_erase_left = emu_erase_until - emu_erase_resumed;
+			else
+				emu_erase_left = emu_erase_until - now;
+			emu_erase_until = 0;
+			emu_erase_suspends++;
+			return 0;
+		default:
+			msg_perr("Command 0x%02x sent while erasing!\n", writearr[0]);
+			return 0;
+		}
+	}
+	if (!emu_erase_left)
+		return -1;
+
+	switch (writearr[0]) {
+	case JEDEC_ERASE_RESUME:
+		emu_erase_resumed = now;
+		emu_erase_until = now + emu_erase_left;
+		emu_erase_left = 0;
+		return 0;
+	case JEDEC_READ:
+	case JEDEC_FAST_READ:
+		if (writecnt < 4)
+			return -1;
+		offs = (writearr[1] << 16 | writearr[2] << 8 | writearr[3]) % emu_chip_size;
+		if (offs < emu_erase_start + emu_erase_len && emu_erase_start < offs + readcnt)
+			msg_perr("Read of the block that is being erased while the erase is suspended!\n");
+		emu_suspended_reads++;
+		emu_suspended_read_bytes += readcnt;
+		return -1;
+	case JEDEC_RDSR:
+	case WINBOND_RDSR_2:
+		return -1;
+	default:
+		msg_perr("Command 0x%02x sent while an erase is suspended!\n", writearr[0]);
+		return 0;
+	}
+}
+
+/* Keeps the selected die busy and accounts the time the other dies are busy, too. */
+static void emu_die_start_busy(const unsigned int duration)
+{
+	const uint64_t now = emu_now_us();
+	unsigned int die;
+
+	for (die = 0; die < emu_dies; ++die) {
+		if (die == emu_selected_die || emu_die_busy_until[die] <= now)
+			continue;
+		if (emu_die_busy_until[die] < now + duration)
+			emu_dies_overlap_us += emu_die_busy_until[die] - now;
+		else
+			emu_dies_overlap_us += duration;
+	}
+	emu_die_busy_until[emu_selected_die] = now + duration;
+	emu_die_busy_us[emu_selected_die] += duration;
+}
+
+/*
+ * Returns true if the W25Q128FW protects any of `len` bytes at `offs` with
+ * BP0-2, TB and SEC in SR1 and CMP in SR2. The chip ignores such programs
+ * and erases, which is counted.
+ */
+static bool emu_write_protected(const unsigned int offs, const unsigned int len)
+{
+	const unsigned int bp = (emu_status >> 2) & 0x07;
+	unsigned int prot, start;
+	bool hit;
+
+	if (emu_chip != EMULATE_WINBOND_W25Q128FW)
+		return false;
+
+	if (bp == 0)
+		prot = 0;
+	else if (bp == 7)
+		prot = emu_chip_size;
+	else if (emu_status & (1 << 6))
+		prot = min(4 * 1024 << (bp - 1), 32 * 1024);
+	else
+		prot = emu_chip_size / 64 << (bp - 1);
+	/* TB selects the bottom. */
+	start = (emu_status & (1 << 5)) ? 0 : emu_chip_size - prot;
+
+	hit = offs < start + prot && start < offs + len;
+	/* CMP protects everything else. */
+	if (emu_status2 & SPI_SR2_CMP)
+		hit = offs < start || start + prot < offs + len;
+	if (hit) {
+		msg_pdbg("0x%06x-0x%06x is protected, ignoring the command.\n", offs, offs + len - 1);
+		emu_protected_writes++;
+	}
+	return hit;
+}
+
+/*
+ * Handles the commands that address a single die of stacked-die chips.
+ *
+ * Returns 0 if the command was handled, 1 on errors and -1 if the command
+ * isn't die-specific.
+ */
+static int emulate_stacked_die(unsigned int writecnt, unsigned int readcnt,
+			       const unsigned char *writearr, unsigned char *readarr)
+{
+	const unsigned int die_size = emu_chip_size / emu_dies;
+	const bool busy = emu_now_us() < emu_die_busy_until[emu_selected_die];
+	unsigned int offs, blocksize;
+
+	switch (writearr[0]) {
+	case WINBOND_DIE_SELECT:
+		if (writecnt != 2 || writearr[1] >= emu_dies) {
+			msg_perr("DIE SELECT invalid!\n");
+			return 1;
+		}
+		emu_die_status[emu_selected_die] = emu_status;
+		emu_selected_die = writearr[1];
+		emu_status = emu_die_status[emu_selected_die];
+		return 0;
+	case JEDEC_RDSR:
+		memset(readarr, emu_status | (busy ? SPI_SR_WIP : 0), readcnt);
+		return 0;
+	}
+
+	/* A busy die only answers RDSR. */
+	if (busy) {
+		msg_perr("Command 0x%02x sent to die %u while it's busy!\n", writearr[0], emu_selected_die);
+		return 0;
+	}
+
+	switch (writearr[0]) {
+	case JEDEC_READ_4BA:
+	case JEDEC_BYTE_PROGRAM_4BA:
+	case 0x21:
+	case 0xdc:
+		break;
+	default:
+		return -1;
+	}
+
+	if (writecnt < 5) {
+		msg_perr("4BA command 0x%02x too short!\n", writearr[0]);
+		return 1;
+	}
+	offs = (unsigned int)writearr[1] << 24 | writearr[2] << 16 | writearr[3] << 8 | writearr[4];
+	/* Truncate to the die size. */
+	offs = emu_selected_die * die_size + offs % die_size;
+
+	if (writearr[0] == JEDEC_READ_4BA) {
+		memcpy(readarr, flashchip_contents + offs, min(readcnt, emu_chip_size - offs));
+		return 0;
+	}
+
+	if (!(emu_status & SPI_SR_WEL)) {
+		msg_perr("Command 0x%02x attempted, but WEL is 0!\n", writearr[0]);
+		return 0;
+	}
+	emu_status &= ~SPI_SR_WEL;
+
+	if (writearr[0] == JEDEC_BYTE_PROGRAM_4BA) {
+		if (writecnt - 5 > emu_max_byteprogram_size) {
+			msg_perr("Max BYTE PROGRAM size exceeded!\n");
+			return 1;
+		}
+		memcpy(flashchip_contents + offs, writearr + 5, writecnt - 5);
+		emu_die_start_busy(EMU_DIE_PROGRAM_US);
+		return 0;
+	}
+
+	blocksize = writearr[0] == 0x21 ? 4 * 1024 : 64 * 1024;
+	if (offs & (blocksize - 1))
+		msg_pdbg("Unaligned BLOCK ERASE 0x%02x: 0x%x\n", writearr[0], offs);
+	offs &= ~(blocksize - 1);
+	memset(flashchip_contents + offs, 0xff, blocksize);
+	emu_die_start_busy(writearr[0] == 0x21 ? EMU_DIE_SE_US : EMU_DIE_BE_US);
+	return 0;
+}
+
 static int emulate_spi_chip_response(unsigned int writecnt,
 				     unsigned int readcnt,
 				     const unsigned char *writearr,
@@ -512,6 +1365,14 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		}
 	}
 
+	if (emu_dies) {
+		const int ret = emulate_stacked_die(writecnt, readcnt, writearr, readarr);
+		if (ret >= 0)
+			return ret;
+	}
+	if (emu_erase_time && emulate_erase_busy(writecnt, readcnt, writearr, readarr) == 0)
+		return 0;
+
 	switch (writearr[0]) {
 	case JEDEC_RES:
 		if (writecnt < JEDEC_RES_OUTSIZE)
@@ -581,6 +1442,22 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 			if (readcnt > 2)
 				readarr[2] = 0x17;
 			break;
+		case EMULATE_WINBOND_W25Q128FW:
+			if (readcnt > 0)
+				readarr[0] = 0xef;
+			if (readcnt > 1)
+				readarr[1] = 0x60;
+			if (readcnt > 2)
+				readarr[2] = 0x18;
+			break;
+		case EMULATE_WINBOND_W25M512JV:
+			if (readcnt > 0)
+				readarr[0] = 0xef;
+			if (readcnt > 1)
+				readarr[1] = 0x71;
+			if (readcnt > 2)
+				readarr[2] = 0x19;
+			break;
 		default: /* ignore */
 			break;
 		}
@@ -588,6 +1465,20 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 	case JEDEC_RDSR:
 		memset(readarr, emu_status, readcnt);
 		break;
+	case WINBOND_RDSR_2:
+		if (emu_chip != EMULATE_WINBOND_W25Q128FW)
+			break;
+		memset(readarr, emu_status2, readcnt);
+		break;
+	case JEDEC_ENTER_QPI:
+		if (emu_chip != EMULATE_WINBOND_W25Q128FW || !(emu_status2 & SPI_SR2_QE))
+			break;
+		emu_qpi_mode = true;
+		break;
+	case JEDEC_EXIT_QPI:
+		/* Outside of QPI mode, 0xff is ignored. */
+		emu_qpi_mode = false;
+		break;
 	/* FIXME: this should be chip-specific. */
 	case JEDEC_EWSR:
 	case JEDEC_WREN:
@@ -598,17 +1489,51 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 			msg_perr("WRSR attempted, but WEL is 0!\n");
 			break;
 		}
+		if (emu_chip == EMULATE_WINBOND_W25Q128FW && (emu_status2 & SPI_SR2_SRP1)) {
+			msg_pdbg("WRSR ignored, the status registers are locked.\n");
+			break;
+		}
 		/* FIXME: add some reasonable simulation of the busy flag */
 		emu_status = writearr[1] & ~SPI_SR_WIP;
 		msg_pdbg2("WRSR wrote 0x%02x.\n", emu_status);
+		/* Winbond chips take SR2 as second byte. */
+		if (emu_chip == EMULATE_WINBOND_W25Q128FW && writecnt > JEDEC_WRSR_OUTSIZE) {
+			emu_status2 = writearr[2];
+			msg_pdbg2("WRSR wrote 0x%02x to SR2.\n", emu_status2);
+		}
 		break;
 	case JEDEC_READ:
+	case JEDEC_FAST_READ:
+		if (emu_qpi_mode && writearr[0] == JEDEC_READ) {
+			msg_perr("READ attempted in QPI mode!\n");
+			break;
+		}
+		if (writearr[0] == JEDEC_FAST_READ) {
+			if (emu_chip != EMULATE_WINBOND_W25Q128FW)
+				break;
+			if (writecnt != JEDEC_FAST_READ_OUTSIZE) {
+				msg_perr("FAST READ outsize invalid!\n");
+				return 1;
+			}
+		}
 		offs = writearr[1] << 16 | writearr[2] << 8 | writearr[3];
 		/* Truncate to emu_chip_size. */
 		offs %= emu_chip_size;
 		if (readcnt > 0)
 			memcpy(readarr, flashchip_contents + offs, readcnt);
+		if (readcnt > 0 && emu_read_flips && (unsigned int)rand() % 100 < emu_read_flips) {
+			readarr[rand() % readcnt] ^= 1 << (rand() % 8);
+			emu_read_flips_injected++;
+		}
 		break;
+	case JEDEC_QUAD_PAGE_PROGRAM:
+		if (emu_chip != EMULATE_WINBOND_W25Q128FW || !(emu_status2 & SPI_SR2_QE))
+			break;
+		if (emu_qpi_mode) {
+			msg_perr("QUAD PAGE PROGRAM attempted in QPI mode!\n");
+			break;
+		}
+		/* fall through */
 	case JEDEC_BYTE_PROGRAM:
 		offs = writearr[1] << 16 | writearr[2] << 8 | writearr[3];
 		/* Truncate to emu_chip_size. */
@@ -621,7 +1546,13 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 			msg_perr("Max BYTE PROGRAM size exceeded!\n");
 			return 1;
 		}
+		if (emu_write_protected(offs, writecnt - 4))
+			break;
 		memcpy(flashchip_contents + offs, writearr + 4, writecnt - 4);
+		if (emu_program_faults && (unsigned int)rand() % 100 < emu_program_faults) {
+			flashchip_contents[offs + rand() % (writecnt - 4)] = 0xff;
+			emu_program_faults_injected++;
+		}
 		break;
 	case JEDEC_AAI_WORD_PROGRAM:
 		if (!emu_max_aai_size)
@@ -678,7 +1609,10 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		if (offs & (emu_jedec_se_size - 1))
 			msg_pdbg("Unaligned SECTOR ERASE 0x20: 0x%x\n", offs);
 		offs &= ~(emu_jedec_se_size - 1);
+		if (emu_write_protected(offs, emu_jedec_se_size))
+			break;
 		memset(flashchip_contents + offs, 0xff, emu_jedec_se_size);
+		emu_start_erase(offs, emu_jedec_se_size);
 		break;
 	case JEDEC_BE_52:
 		if (!emu_jedec_be_52_size)
@@ -695,7 +1629,10 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		if (offs & (emu_jedec_be_52_size - 1))
 			msg_pdbg("Unaligned BLOCK ERASE 0x52: 0x%x\n", offs);
 		offs &= ~(emu_jedec_be_52_size - 1);
+		if (emu_write_protected(offs, emu_jedec_be_52_size))
+			break;
 		memset(flashchip_contents + offs, 0xff, emu_jedec_be_52_size);
+		emu_start_erase(offs, emu_jedec_be_52_size);
 		break;
 	case JEDEC_BE_D8:
 		if (!emu_jedec_be_d8_size)
@@ -712,7 +1649,10 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		if (offs & (emu_jedec_be_d8_size - 1))
 			msg_pdbg("Unaligned BLOCK ERASE 0xd8: 0x%x\n", offs);
 		offs &= ~(emu_jedec_be_d8_size - 1);
+		if (emu_write_protected(offs, emu_jedec_be_d8_size))
+			break;
 		memset(flashchip_contents + offs, 0xff, emu_jedec_be_d8_size);
+		emu_start_erase(offs, emu_jedec_be_d8_size);
 		break;
 	case JEDEC_CE_60:
 		if (!emu_jedec_ce_60_size)
@@ -727,7 +1667,10 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		}
 		/* JEDEC_CE_60_OUTSIZE is 1 (no address) -> no offset. */
 		/* emu_jedec_ce_60_size is emu_chip_size. */
+		if (emu_write_protected(0, emu_jedec_ce_60_size))
+			break;
 		memset(flashchip_contents, 0xff, emu_jedec_ce_60_size);
+		emu_start_erase(0, emu_jedec_ce_60_size);
 		break;
 	case JEDEC_CE_C7:
 		if (!emu_jedec_ce_c7_size)
@@ -742,7 +1685,10 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		}
 		/* JEDEC_CE_C7_OUTSIZE is 1 (no address) -> no offset. */
 		/* emu_jedec_ce_c7_size is emu_chip_size. */
+		if (emu_write_protected(0, emu_jedec_ce_c7_size))
+			break;
 		memset(flashchip_contents, 0xff, emu_jedec_ce_c7_size);
+		emu_start_erase(0, emu_jedec_ce_c7_size);
 		break;
 	case JEDEC_SFDP:
 		if (emu_chip != EMULATE_MACRONIX_MX25L6436)
@@ -801,15 +1747,37 @@ static int dummy_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 	msg_pspew(" writing %u bytes:", writecnt);
 	for (i = 0; i < writecnt; i++)
 		msg_pspew(" 0x%02x", writearr[i]);
+	if (writecnt) {
+		spi_command_count[writearr[0]]++;
+		dummy_start_op(dummy_spi_op(writearr[0]));
+	}
+
+	/* Four lines take two clocks per byte, one line takes eight. */
+	if (flash->in_qpi_mode) {
+		spi_bus_clocks += 2 * (writecnt + readcnt);
+	} else if (writecnt && writearr[0] == JEDEC_QUAD_PAGE_PROGRAM) {
+		const unsigned int cmdlen = min(writecnt, 1 + (flash->in_4ba_mode ? 4 : 3));
+		spi_bus_clocks += 8 * cmdlen + 2 * (writecnt - cmdlen);
+	} else {
+		spi_bus_clocks += 8 * (writecnt + readcnt);
+	}
 
 	/* Response for unknown commands and missing chip is 0xff. */
 	memset(readarr, 0xff, readcnt);
 #if EMULATE_SPI_CHIP
+	/* The chip can't make sense of commands sent with the wrong I/O width. */
+	if (flash->in_qpi_mode != emu_qpi_mode) {
+		msg_pdbg("Command sent in %s mode, but the chip is in %s mode!\n",
+			 flash->in_qpi_mode ? "QPI" : "SPI", emu_qpi_mode ? "QPI" : "SPI");
+		goto out;
+	}
 	switch (emu_chip) {
 	case EMULATE_ST_M25P10_RES:
 	case EMULATE_SST_SST25VF040_REMS:
 	case EMULATE_SST_SST25VF032B:
 	case EMULATE_MACRONIX_MX25L6436:
+	case EMULATE_WINBOND_W25Q128FW:
+	case EMULATE_WINBOND_W25M512JV:
 		if (emulate_spi_chip_response(writecnt, readcnt, writearr,
 					      readarr)) {
 			msg_pdbg("Invalid command sent to flash chip!\n");
@@ -819,6 +1787,7 @@ static int dummy_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 	default:
 		break;
 	}
+out:
 #endif
 	msg_pspew(" reading %u bytes:", readcnt);
 	for (i = 0; i < readcnt; i++)
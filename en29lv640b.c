@@ -36,10 +36,20 @@ int write_en29lv640b(struct flashctx *flash, const uint8_t *src, unsigned int st
 	int i;
 	chipaddr bios = flash->virtual_memory;
 	chipaddr dst = flash->virtual_memory + start;
+	bool bypass = flash->chip->feature_bits & FEATURE_UNLOCK_BYPASS;
 
-	for (i = 0; i < len; i += 2) {
+	/* In unlock bypass mode, only the 0xA0 cycle precedes each word. */
+	if (bypass) {
 		chip_writeb(flash, 0xAA, bios + 0xAAA);
 		chip_writeb(flash, 0x55, bios + 0x555);
+		chip_writeb(flash, 0x20, bios + 0xAAA);
+	}
+
+	for (i = 0; i < len; i += 2) {
+		if (!bypass) {
+			chip_writeb(flash, 0xAA, bios + 0xAAA);
+			chip_writeb(flash, 0x55, bios + 0x555);
+		}
 		chip_writeb(flash, 0xA0, bios + 0xAAA);
 
 		/* Transfer data from source to destination. */
@@ -54,6 +64,11 @@ int write_en29lv640b(struct flashctx *flash, const uint8_t *src, unsigned int st
 		src += 2;
 	}
 
+	if (bypass) {
+		chip_writeb(flash, 0x90, bios);
+		chip_writeb(flash, 0x00, bios);
+	}
+
 	/* FIXME: Ignore errors for now. */
 	return 0;
 }
@@ -104,6 +104,7 @@ enum write_granularity {
 
 /* Feature bits used for non-SPI only */
 #define FEATURE_REGISTERMAP	(1 << 0)
+#define FEATURE_UNLOCK_BYPASS	(1 << 1) /**< AMD-style unlock bypass (0x20) shortens byte programs. */
 #define FEATURE_LONG_RESET	(0 << 4)
 #define FEATURE_SHORT_RESET	(1 << 4)
 #define FEATURE_EITHER_RESET	FEATURE_LONG_RESET
@@ -126,6 +127,10 @@ enum write_granularity {
 #define FEATURE_4BA_READ	(1 << 13) /**< Native 4BA read instruction (0x13) is supported. */
 #define FEATURE_4BA_FAST_READ	(1 << 14) /**< Native 4BA fast read instruction (0x0c) is supported. */
 #define FEATURE_4BA_WRITE	(1 << 15) /**< Native 4BA byte program (0x12) is supported. */
+#define FEATURE_QUAD_PROGRAM	(1 << 16) /**< Quad input page program (0x32) is supported if the QE bit
+					       (bit 1 of status register 2) is set. Combined with FEATURE_QPI,
+					       QPI mode is entered with 0x38 and left with 0xff. */
+#define FEATURE_FAST_READ	(1 << 17) /**< Fast read (0x0b) with one dummy byte is supported. */
 /* 4BA Shorthands */
 #define FEATURE_4BA_NATIVE	(FEATURE_4BA_READ | FEATURE_4BA_FAST_READ | FEATURE_4BA_WRITE)
 #define FEATURE_4BA		(FEATURE_4BA_ENTER | FEATURE_4BA_EXT_ADDR | FEATURE_4BA_NATIVE)
@@ -155,6 +160,21 @@ struct flashrom_flashctx;
 #define flashctx flashrom_flashctx /* TODO: Agree on a name and convert all occurences. */
 typedef int (erasefunc_t)(struct flashctx *flash, unsigned int addr, unsigned int blocklen);
 
+/* A part of the chip that can't be erased or written as long as its protection is in effect. */
+struct protected_range {
+	chipoff_t start;
+	chipsize_t len;
+	bool read;	/* Reading is blocked as well. */
+	bool fixed;	/* Software can't remove the protection, e.g. it's locked down. */
+};
+
+#define MAX_PROTECTED_RANGES 64
+#define MAX_LOCK_BLOCKS 64
+struct protection {
+	size_t count;
+	struct protected_range ranges[MAX_PROTECTED_RANGES];
+};
+
 struct flashchip {
 	const char *vendor;
 	const char *name;
@@ -173,6 +193,8 @@ struct flashchip {
 	unsigned int total_size;
 	/* Chip page size in bytes */
 	unsigned int page_size;
+	/* Number of stacked dies of equal size, selected with 0xc2. 0 means one die. */
+	unsigned int dies;
 	int feature_bits;
 
 	/* Indicate how well flashrom supports different operations of this flash chip. */
@@ -207,8 +229,28 @@ struct flashchip {
 		int (*block_erase) (struct flashctx *flash, unsigned int blockaddr, unsigned int blocklen);
 	} block_erasers[NUM_ERASEFUNCTIONS];
 
+	/*
+	 * Erase suspend (0x75) and resume (0x7a) timing in microseconds: the
+	 * longest time the chip takes to suspend an erase and the shortest
+	 * time an erase has to run between two suspends to make progress.
+	 * Zero if erases can't be suspended. `max_count` is the most suspends
+	 * per erase, after that the erase runs to the end undisturbed.
+	 */
+	struct erase_suspend {
+		unsigned int latency;
+		unsigned int interval;
+		unsigned int max_count;
+	} erase_suspend;
+
 	int (*printlock) (struct flashctx *flash);
 	int (*unlock) (struct flashctx *flash);
+	/*
+	 * Optional: decodes the protection in effect into address ranges.
+	 * Chips that have it are only unlocked where an operation needs it.
+	 */
+	int (*protection) (struct flashctx *flash, struct protection *prot);
+	/* Optional: removes the protection of a range, may unprotect more. unlock() is used otherwise. */
+	int (*unprotect) (struct flashctx *flash, chipoff_t start, chipsize_t len);
 	int (*write) (struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len);
 	int (*read) (struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
 	struct voltage {
@@ -237,6 +279,8 @@ struct flashrom_flashctx {
 		bool force_boardmismatch;
 		bool verify_after_write;
 		bool verify_whole_chip;
+		bool consistent_read;
+		bool erase_suspend;
 	} flags;
 	/* We cache the state of the extended address register (highest byte
            of a 4BA for 3BA instructions) and the state of the 4BA mode here.
@@ -244,6 +288,25 @@ struct flashrom_flashctx {
            of the extended address register. */
 	int address_high_byte;
 	bool in_4ba_mode;
+	/* I/O mode negotiated in prepare_chip_access(). In QPI mode, every
+	   command runs on four I/O lines. Otherwise, page programs may send
+	   their data on four lines. */
+	bool in_qpi_mode;
+	bool quad_program;
+	/* Stacked-die chips: the die selected last (-1 if unknown) and a bitmap of
+	   dies that may still be busy. While `defer_wip` is set, erase and program
+	   commands return without waiting for the die to finish. */
+	int selected_die;
+	unsigned int busy_dies;
+	bool defer_wip;
+	/* Set between flashrom_session_begin() and flashrom_session_end(). */
+	bool in_session;
+	/* Ranges left protected by the current erase or write, see plan_protection(). */
+	struct protection protection;
+	/* Lock registers of FWH/LPC chips, one per lock block. They are read once
+	   per flash access and kept up to date on writes, see regspace2_locks(). */
+	bool locks_valid;
+	uint8_t locks[MAX_LOCK_BLOCKS];
 };
 
 /* Timing used in probe routines. ZERO is -2 to differentiate between an unset
@@ -277,6 +340,7 @@ uint32_t address_to_bits(uint32_t addr);
 int bitcount(unsigned long a);
 int max(int a, int b);
 int min(int a, int b);
+uint64_t fnv1a_64(const uint8_t *buf, size_t len);
 char *strcat_realloc(char *dest, const char *src);
 void tolower_string(char *str);
 #ifdef __MINGW32__
@@ -299,6 +363,7 @@ int read_flash_to_file(struct flashctx *flash, const char *filename);
 char *extract_param(const char *const *haystack, const char *needle, const char *delim);
 int verify_range(struct flashctx *flash, const uint8_t *cmpbuf, unsigned int start, unsigned int len);
 int need_erase(const uint8_t *have, const uint8_t *want, unsigned int len, enum write_granularity gran);
+int protection_add(struct protection *prot, chipoff_t start, chipsize_t len, bool read, bool fixed);
 void print_version(void);
 void print_buildinfo(void);
 void print_banner(void);
@@ -311,8 +376,14 @@ void finalize_flash_access(struct flashctx *);
 int do_read(struct flashctx *, const char *filename);
 int do_erase(struct flashctx *);
 int do_write(struct flashctx *, const char *const filename);
+int do_write_stream(struct flashctx *, const char *filename);
 int do_verify(struct flashctx *, const char *const filename);
 
+/* delta.c */
+int do_read_delta(struct flashctx *, const char *filename, const char *reffile);
+int do_write_delta(struct flashctx *, const char *filename, const char *reffile);
+int do_verify_delta(struct flashctx *, const char *filename, const char *reffile);
+
 /* Something happened that shouldn't happen, but we can go on. */
 #define ERROR_NONFATAL 0x100
 
@@ -904,6 +904,7 @@
 #define WINBOND_NEX_W25Q64_V	0x4017	/* W25Q64BV, W25Q64CV; W25Q64FV in SPI mode (default) */
 #define WINBOND_NEX_W25Q128_V	0x4018	/* W25Q128BV; W25Q128FV in SPI mode (default) */
 #define WINBOND_NEX_W25Q256_V	0x4019	/* W25Q256FV */
+#define WINBOND_NEX_W25M512JV	0x7119	/* Two stacked W25Q256JV dies */
 #define WINBOND_NEX_W25Q20_W	0x5012	/* W25Q20BW */
 #define WINBOND_NEX_W25Q40_W	0x5013	/* W25Q40BW */
 #define WINBOND_NEX_W25Q80_W	0x5014	/* W25Q80BW */
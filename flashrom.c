@@ -358,6 +358,18 @@ const struct programmer_entry programmer_table[] = {
 	},
 #endif
 
+#if CONFIG_LINUX_MTD == 1
+	{
+		.name			= "linux_mtd",
+		.type			= OTHER,
+		.devs.note		= "Device files /dev/mtd*\n",
+		.init			= linux_mtd_init,
+		.map_flash_region	= fallback_map,
+		.unmap_flash_region	= fallback_unmap,
+		.delay			= internal_delay,
+	},
+#endif
+
 #if CONFIG_USBBLASTER_SPI == 1
 	{
 		.name			= "usbblaster_spi",
@@ -424,6 +436,16 @@ static int may_register_shutdown = 0;
 /* Did we change something or was every erase/write skipped (if any)? */
 static bool all_skipped = true;
 
+/* Bytes read from the chip at once for streamed reads. */
+#define STREAM_CHUNK_SIZE (64 * 1024)
+
+/* Granularity and re-reads of the consistency check of reads. */
+#define CONSISTENT_READ_BLOCK 4096
+#define CONSISTENT_READ_RETRIES 3
+
+/* Erase/write attempts per block when repairing a failed verification. */
+#define REPAIR_MAX_ATTEMPTS 3
+
 static int check_block_eraser(const struct flashctx *flash, int k, int log);
 
 int shutdown_free(void *data)
@@ -1306,6 +1328,7 @@ notfound:
 
 	/* Flash registers may more likely not be mapped if the chip was forced.
 	 * Lock info may be stored in registers, so avoid lock info printing. */
+	flash->locks_valid = false;
 	if (!force)
 		if (flash->chip->printlock)
 			flash->chip->printlock(flash);
@@ -1357,30 +1380,12 @@ out:
 #endif
 }
 
-int write_buf_to_file(const unsigned char *buf, unsigned long size, const char *filename)
+#ifndef __LIBPAYLOAD__
+/* Flushes, syncs and closes an image file that was written to. */
+static int close_image_file(FILE *const image, const char *const filename)
 {
-#ifdef __LIBPAYLOAD__
-	msg_gerr("Error: No file I/O support in libpayload\n");
-	return 1;
-#else
-	FILE *image;
 	int ret = 0;
 
-	if (!filename) {
-		msg_gerr("No filename specified.\n");
-		return 1;
-	}
-	if ((image = fopen(filename, "wb")) == NULL) {
-		msg_gerr("Error: opening file \"%s\" failed: %s\n", filename, strerror(errno));
-		return 1;
-	}
-
-	unsigned long numbytes = fwrite(buf, 1, size, image);
-	if (numbytes != size) {
-		msg_gerr("Error: file %s could not be written completely.\n", filename);
-		ret = 1;
-		goto out;
-	}
 	if (fflush(image)) {
 		msg_gerr("Error: flushing file \"%s\" failed: %s\n", filename, strerror(errno));
 		ret = 1;
@@ -1391,21 +1396,45 @@ int write_buf_to_file(const unsigned char *buf, unsigned long size, const char *
 	if (fstat(fileno(image), &image_stat) != 0) {
 		msg_gerr("Error: getting metadata of file \"%s\" failed: %s\n", filename, strerror(errno));
 		ret = 1;
-		goto out;
-	}
-	if (S_ISREG(image_stat.st_mode)) {
+	} else if (S_ISREG(image_stat.st_mode)) {
 		if (fsync(fileno(image))) {
 			msg_gerr("Error: fsyncing file \"%s\" failed: %s\n", filename, strerror(errno));
 			ret = 1;
 		}
 	}
 #endif
-out:
 	if (fclose(image)) {
 		msg_gerr("Error: closing file \"%s\" failed: %s\n", filename, strerror(errno));
 		ret = 1;
 	}
 	return ret;
+}
+#endif
+
+int write_buf_to_file(const unsigned char *buf, unsigned long size, const char *filename)
+{
+#ifdef __LIBPAYLOAD__
+	msg_gerr("Error: No file I/O support in libpayload\n");
+	return 1;
+#else
+	FILE *image;
+
+	if (!filename) {
+		msg_gerr("No filename specified.\n");
+		return 1;
+	}
+	if ((image = fopen(filename, "wb")) == NULL) {
+		msg_gerr("Error: opening file \"%s\" failed: %s\n", filename, strerror(errno));
+		return 1;
+	}
+
+	unsigned long numbytes = fwrite(buf, 1, size, image);
+	if (numbytes != size) {
+		msg_gerr("Error: file %s could not be written completely.\n", filename);
+		(void)fclose(image);
+		return 1;
+	}
+	return close_image_file(image, filename);
 #endif
 }
 
@@ -1560,7 +1589,69 @@ static int read_by_layout(struct flashctx *const flashctx, uint8_t *const buffer
 	return 0;
 }
 
+/** @private */
+struct stream_info {
+	flashrom_source_callback *source;
+	void *data;
+	uint8_t *curcontents;
+	uint8_t *newcontents;
+	bool verify;
+	bool verify_failed;
+};
+
+/** @private */
+struct repair_stats {
+	unsigned int blocks;	/* erase blocks that failed verification */
+	unsigned int repaired;
+	unsigned int attempts;
+	unsigned long erased;	/* bytes erased by all attempts */
+};
+
 typedef int (*erasefn_t)(struct flashctx *, unsigned int addr, unsigned int len);
+
+/** @private */
+struct die_job {
+	erasefn_t erasefn;
+	chipoff_t start;
+	chipsize_t len;
+	uint8_t *curcontents;		/* of this erase block */
+	const uint8_t *newcontents;	/* NULL to erase only */
+	uint8_t *merged;		/* newcontents of blocks shared with data outside the regions */
+	chipoff_t pos;			/* write progress within the block */
+	enum {
+		DIE_JOB_ERASE,
+		DIE_JOB_CHECK,
+		DIE_JOB_WRITE,
+		DIE_JOB_DONE,
+	} state;
+};
+
+/** @private */
+struct die_sched {
+	struct die_job *jobs;
+	size_t count;
+	size_t capacity;
+};
+
+/**
+ * @private
+ *
+ * Written ranges that are read back for verification while an erase is
+ * suspended. Everything before `head` (and `done` bytes of the range at
+ * `head`) is verified already.
+ */
+struct suspend_reads {
+	struct suspend_range {
+		chipoff_t start;
+		chipsize_t len;
+	} *ranges;
+	size_t count;
+	size_t capacity;
+	size_t head;
+	chipsize_t done;
+	bool stop;			/* leave everything else to the final verification */
+	const uint8_t *newcontents;
+};
 /**
  * @private
  *
@@ -1572,11 +1663,27 @@ typedef int (*erasefn_t)(struct flashctx *, unsigned int addr, unsigned int len)
  *
  * For erase, `curcontents` and `newcontents` shall be NULL-pointers.
  *
+ * For streamed writes, `curcontents` and `newcontents` are NULL too and
+ * `stream` holds the source and two buffers of one erase block each.
+ *
+ * For repairs after a failed verification, `curcontents` holds the read
+ * back contents and `repair` collects the statistics.
+ *
+ * For chips with stacked dies, `sched` collects the work per erase block,
+ * which is then interleaved between the dies by `run_die_jobs()`.
+ *
+ * If `reads` is set, written blocks are read back while later erases are
+ * suspended, see `erase_block_suspending()`.
+ *
  * The `chipoff_t` values are used internally by `walk_by_layout()`.
  */
 struct walk_info {
 	uint8_t *curcontents;
 	const uint8_t *newcontents;
+	struct stream_info *stream;
+	struct repair_stats *repair;
+	struct die_sched *sched;
+	struct suspend_reads *reads;
 	chipoff_t region_start;
 	chipoff_t region_end;
 	chipoff_t erase_start;
@@ -1596,10 +1703,22 @@ static int walk_eraseblocks(struct flashctx *const flashctx,
 
 	info->erase_start = 0;
 	for (i = 0; i < NUM_ERASEREGIONS; ++i) {
+		const unsigned int size = eraser->eraseblocks[i].size;
+		const unsigned int count = eraser->eraseblocks[i].count;
+
+		/* Erase regions are runs of equally sized blocks, so we can jump
+		   straight to the first block that overlaps the current region. */
+		j = 0;
+		if (count && info->region_start > info->erase_start) {
+			const size_t skip = (info->region_start - info->erase_start) / size;
+			j = skip < count ? skip : count;
+			info->erase_start += j * size;
+		}
+
 		/* count==0 for all automatically initialized array
 		   members so the loop below won't be executed for them. */
-		for (j = 0; j < eraser->eraseblocks[i].count; ++j, info->erase_start = info->erase_end + 1) {
-			info->erase_end = info->erase_start + eraser->eraseblocks[i].size - 1;
+		for (; j < count; ++j, info->erase_start = info->erase_end + 1) {
+			info->erase_end = info->erase_start + size - 1;
 
 			/* Skip any eraseblock that is completely outside the current region. */
 			if (info->erase_end < info->region_start)
@@ -1625,6 +1744,361 @@ static int walk_eraseblocks(struct flashctx *const flashctx,
 	return 0;
 }
 
+/* Appends a range to `prot`, merging it with the previous one if they touch and share the flags. */
+int protection_add(struct protection *const prot, const chipoff_t start, const chipsize_t len,
+		   const bool read, const bool fixed)
+{
+	if (prot->count) {
+		struct protected_range *const last = &prot->ranges[prot->count - 1];
+		if (last->start + last->len == start && last->read == read && last->fixed == fixed) {
+			last->len += len;
+			return 0;
+		}
+	}
+	if (prot->count == MAX_PROTECTED_RANGES) {
+		msg_cerr("More than %d protected ranges, giving up.\n", MAX_PROTECTED_RANGES);
+		return 1;
+	}
+	prot->ranges[prot->count].start = start;
+	prot->ranges[prot->count].len = len;
+	prot->ranges[prot->count].read = read;
+	prot->ranges[prot->count].fixed = fixed;
+	++prot->count;
+	return 0;
+}
+
+/*
+ * Returns true if the current operation changes anything between `start` and
+ * `end`. Without contents, everything in the included regions changes.
+ */
+static bool range_changes(const struct flashctx *const flash, const uint8_t *const curcontents,
+			  const uint8_t *const newcontents, const chipoff_t start, const chipoff_t end)
+{
+	const struct flashrom_layout *const layout = get_layout(flash);
+	size_t i;
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		const struct romentry *const entry = &layout->entries[i];
+		if (!entry->included || entry->end < start || end < entry->start)
+			continue;
+		const chipoff_t from = max(start, entry->start);
+		const chipoff_t to = min(end, entry->end);
+		if (!curcontents || !newcontents ||
+		    memcmp(curcontents + from, newcontents + from, to + 1 - from))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Finds the first byte in [start, end] the current operation changes, see
+ * range_changes(). Returns false if nothing in it changes.
+ */
+static bool next_change(const struct flashctx *const flash, const uint8_t *const curcontents,
+			const uint8_t *const newcontents, const chipoff_t start, chipoff_t end,
+			chipoff_t *const next)
+{
+	const struct flashrom_layout *const layout = get_layout(flash);
+	bool changes = false;
+	size_t i;
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		const struct romentry *const entry = &layout->entries[i];
+		if (!entry->included || entry->end < start || end < entry->start)
+			continue;
+		chipoff_t from = max(start, entry->start);
+		const chipoff_t to = min(end, entry->end);
+		if (curcontents && newcontents) {
+			while (from <= to && curcontents[from] == newcontents[from])
+				++from;
+			if (from > to)
+				continue;
+		}
+		*next = from;
+		end = from - 1;	/* Later entries only matter if they change something earlier. */
+		changes = true;
+		if (from == start)
+			break;
+	}
+	return changes;
+}
+
+/*
+ * Narrows [*start, *end] down to the first run of changes in it. Changes less
+ * than `gap` bytes apart belong to the same run. Returns false if nothing in
+ * it changes.
+ */
+static bool changed_run(const struct flashctx *const flash, const uint8_t *const curcontents,
+			const uint8_t *const newcontents, const chipsize_t gap,
+			chipoff_t *const start, chipoff_t *const end)
+{
+	chipoff_t first, last, next;
+
+	if (!next_change(flash, curcontents, newcontents, *start, *end, &first))
+		return false;
+	for (last = first; last < *end; last = next) {
+		const chipoff_t limit = *end - last > gap ? last + gap : *end;
+		if (!next_change(flash, curcontents, newcontents, last + 1, limit, &next))
+			break;
+	}
+	*start = first;
+	*end = last;
+	return true;
+}
+
+/*
+ * Returns the size of the smallest erase block of the chip. Unchanged parts
+ * shorter than that can't hold a whole protection unit of their own.
+ */
+static chipsize_t smallest_eraseblock(const struct flashchip *const chip)
+{
+	chipsize_t smallest = chip->total_size * 1024;
+	size_t k, i;
+
+	for (k = 0; k < NUM_ERASEFUNCTIONS; ++k) {
+		for (i = 0; i < NUM_ERASEREGIONS; ++i) {
+			const unsigned int size = chip->block_erasers[k].eraseblocks[i].size;
+			if (size && size < smallest)
+				smallest = size;
+		}
+	}
+	return smallest;
+}
+
+static bool range_protected(const struct protection *const prot, const chipoff_t start, const chipoff_t end)
+{
+	size_t i;
+
+	for (i = 0; i < prot->count; ++i) {
+		if (prot->ranges[i].start <= end && start <= prot->ranges[i].start + prot->ranges[i].len - 1)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Returns true if erase function `k` would have to erase a block of the current
+ * region that changes and overlaps a range that stays protected. The chip would
+ * silently ignore that erase.
+ */
+static bool eraser_hits_protection(const struct flashctx *const flash,
+				   const struct walk_info *const info, const size_t k)
+{
+	const struct block_eraser *const eraser = &flash->chip->block_erasers[k];
+	chipoff_t start = 0;
+	size_t i, j;
+
+	if (!flash->protection.count)
+		return false;
+
+	for (i = 0; i < NUM_ERASEREGIONS; ++i) {
+		const unsigned int size = eraser->eraseblocks[i].size;
+		for (j = 0; j < eraser->eraseblocks[i].count; ++j, start += size) {
+			const chipoff_t end = start + size - 1;
+			if (end < info->region_start)
+				continue;
+			if (info->region_end < start)
+				return false;
+			if (range_protected(&flash->protection, start, end) &&
+			    range_changes(flash, info->curcontents, info->newcontents,
+					  max(start, info->region_start), min(end, info->region_end)))
+				return true;
+		}
+	}
+	return false;
+}
+
+/* Queues the work for one erase block of a stacked-die chip, see run_die_jobs(). */
+static int plan_die_job(struct flashctx *const flashctx,
+			const struct walk_info *const info, const erasefn_t erasefn)
+{
+	struct die_sched *const sched = info->sched;
+	const chipsize_t erase_len = info->erase_end + 1 - info->erase_start;
+	struct die_job *job = NULL;
+	bool created = false;
+	size_t i;
+
+	/* Regions that share an erase block share its job. */
+	for (i = 0; i < sched->count; ++i) {
+		if (sched->jobs[i].start == info->erase_start) {
+			job = &sched->jobs[i];
+			break;
+		}
+	}
+	if (!job) {
+		if (sched->count == sched->capacity) {
+			const size_t capacity = sched->capacity ? 2 * sched->capacity : 256;
+			struct die_job *const jobs = realloc(sched->jobs, capacity * sizeof(*jobs));
+			if (!jobs) {
+				msg_cerr("Out of memory!\n");
+				return 2;
+			}
+			sched->jobs = jobs;
+			sched->capacity = capacity;
+		}
+		job = &sched->jobs[sched->count++];
+		created = true;
+		*job = (struct die_job){
+			.erasefn	= erasefn,
+			.start		= info->erase_start,
+			.len		= erase_len,
+			.curcontents	= info->curcontents ? info->curcontents + info->erase_start : NULL,
+			.newcontents	= info->newcontents ? info->newcontents + info->erase_start : NULL,
+			.state		= DIE_JOB_ERASE,
+		};
+	}
+
+	if (!info->newcontents)
+		return 0;
+	if (info->region_start <= info->erase_start && info->erase_end <= info->region_end && !job->merged)
+		return 0;
+
+	/* Like read_erase_write_block(), keep the data outside of the region. */
+	if (!job->merged) {
+		job->merged = malloc(erase_len);
+		if (!job->merged) {
+			msg_cerr("Out of memory!\n");
+			return 2;
+		}
+		if (created) {
+			msg_cdbg("R");
+			if (flashctx->chip->read(flashctx, job->merged, job->start, erase_len)) {
+				msg_cerr("Can't read! Aborting.\n");
+				return 2;
+			}
+			memcpy(job->curcontents, job->merged, erase_len);
+		} else {
+			/* An earlier region covered the whole block. */
+			memcpy(job->merged, job->newcontents, erase_len);
+		}
+		job->newcontents = job->merged;
+	}
+	const chipoff_t start = max(info->region_start, info->erase_start);
+	const chipoff_t end = min(info->region_end, info->erase_end);
+	memcpy(job->merged + start - job->start, info->newcontents + start, end + 1 - start);
+	return 0;
+}
+
+/* Issues the next operation of `job`. The job's die has to be idle. */
+static int step_die_job(struct flashctx *const flashctx, struct die_job *const job)
+{
+	const struct flashchip *const chip = flashctx->chip;
+
+	switch (job->state) {
+	case DIE_JOB_ERASE:
+		if (job->newcontents && !need_erase(job->curcontents, job->newcontents, job->len, chip->gran)) {
+			job->state = DIE_JOB_WRITE;
+			return 0;
+		}
+		all_skipped = false;
+		if (job->erasefn(flashctx, job->start, job->len))
+			return 1;
+		job->state = DIE_JOB_CHECK;
+		return 0;
+	case DIE_JOB_CHECK:
+		if (check_erased_range(flashctx, job->start, job->len)) {
+			msg_cerr("ERASE FAILED at 0x%06x!\n", job->start);
+			return 1;
+		}
+		if (job->curcontents)
+			memset(job->curcontents, 0xff, job->len);
+		job->state = job->newcontents ? DIE_JOB_WRITE : DIE_JOB_DONE;
+		return 0;
+	case DIE_JOB_WRITE: {
+		unsigned int start = job->pos;
+		unsigned int len = get_next_write(job->curcontents + job->pos, job->newcontents + job->pos,
+						  job->len - job->pos, &start, chip->gran);
+		if (!len) {
+			job->state = DIE_JOB_DONE;
+			return 0;
+		}
+		/* A single page, so the die is only busy with one program. */
+		const chipoff_t addr = job->start + start;
+		len = min(len, chip->page_size - addr % chip->page_size);
+		all_skipped = false;
+		if (chip->write(flashctx, job->newcontents + start, addr, len))
+			return 1;
+		memcpy(job->curcontents + start, job->newcontents + start, len);
+		job->pos = start + len;
+		return 0;
+	}
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Runs the queued jobs of a stacked-die chip. Each die works through its
+ * jobs in order, but while one die is busy erasing or programming, we keep
+ * the others busy. Each die's WIP bit is polled separately.
+ */
+static int run_die_jobs(struct flashctx *const flashctx, struct die_sched *const sched)
+{
+	const unsigned int dies = flashctx->chip->dies;
+	const chipsize_t die_size = flashctx->chip->total_size * 1024 / dies;
+	size_t remaining = sched->count;
+	unsigned int die;
+	int ret = 1;
+
+	size_t *const next = calloc(dies, sizeof(*next));
+	if (!next) {
+		msg_cerr("Out of memory!\n");
+		return 1;
+	}
+
+	msg_cdbg("Interleaving %zu erase blocks on %u dies.\n", sched->count, dies);
+	flashctx->defer_wip = true;
+	while (remaining) {
+		bool issued = false;
+		for (die = 0; die < dies; ++die) {
+			while (next[die] < sched->count &&
+			       (sched->jobs[next[die]].start / die_size != die ||
+				sched->jobs[next[die]].state == DIE_JOB_DONE))
+				++next[die];
+			if (next[die] == sched->count)
+				continue;
+
+			const int busy = spi_die_busy(flashctx, die);
+			if (busy < 0)
+				goto _out;
+			if (busy)
+				continue;
+
+			struct die_job *const job = &sched->jobs[next[die]];
+			if (step_die_job(flashctx, job))
+				goto _out;
+			if (job->state == DIE_JOB_DONE)
+				--remaining;
+			issued = true;
+		}
+		if (!issued)
+			programmer_delay(10);
+	}
+	ret = 0;
+
+_out:
+	flashctx->defer_wip = false;
+	/* Nothing else may talk to a busy die. */
+	for (die = 0; die < dies; ++die) {
+		int busy;
+		while ((busy = spi_die_busy(flashctx, die)) > 0)
+			programmer_delay(10);
+		if (busy < 0)
+			ret = 1;
+	}
+	free(next);
+	return ret;
+}
+
+static void free_die_sched(struct die_sched *const sched)
+{
+	size_t i;
+
+	for (i = 0; i < sched->count; ++i)
+		free(sched->jobs[i].merged);
+	free(sched->jobs);
+}
+
 static int walk_by_layout(struct flashctx *const flashctx, struct walk_info *const info,
 			  const per_blockfn_t per_blockfn)
 {
@@ -1641,14 +2115,18 @@ static int walk_by_layout(struct flashctx *const flashctx, struct walk_info *con
 		info->region_start = layout->entries[i].start;
 		info->region_end   = layout->entries[i].end;
 
-		size_t j;
+		int j;
 		int error = 1; /* retry as long as it's 1 */
 		for (j = (NUM_ERASEFUNCTIONS - 1); j >= 0; j--) {
 			if (j != 0)
 				msg_cinfo("Looking for another erase function.\n");
-			msg_cdbg("Trying erase function %zi... ", j);
+			msg_cdbg("Trying erase function %i... ", j);
 			if (check_block_eraser(flashctx, j, 1))
 				continue;
+			if (eraser_hits_protection(flashctx, info, j)) {
+				msg_cdbg("would erase protected blocks. ");
+				continue;
+			}
 
 			error = walk_eraseblocks(flashctx, info, j, per_blockfn);
 			if (error != 1)
@@ -1674,43 +2152,191 @@ static int walk_by_layout(struct flashctx *const flashctx, struct walk_info *con
 			return 1;
 		}
 	}
+	if (info->sched && run_die_jobs(flashctx, info->sched)) {
+		msg_cerr("FAILED!\n");
+		return 1;
+	}
 	if (all_skipped)
 		msg_cinfo("\nWarning: Chip content is identical to the requested image.\n");
 	msg_cinfo("Erase/write done.\n");
 	return 0;
 }
 
-static int erase_block(struct flashctx *const flashctx,
-		       const struct walk_info *const info, const erasefn_t erasefn)
-{
-	const unsigned int erase_len = info->erase_end + 1 - info->erase_start;
+/* Largest read done while an erase is suspended. */
+#define SUSPEND_READ_SIZE	4096
 
-	all_skipped = false;
+/* Queues the part of the current erase block inside the region for verification. */
+static int queue_suspend_read(struct suspend_reads *const reads, const struct walk_info *const info)
+{
+	const chipoff_t start = max(info->erase_start, info->region_start);
+	const chipoff_t end = min(info->erase_end, info->region_end);
+	struct suspend_range *const last = reads->count ? &reads->ranges[reads->count - 1] : NULL;
+
+	/* Extend the last range unless it's verified already, but keep one
+	   range per region, see suspend_reads_verified(). */
+	if (last && reads->head < reads->count && last->start + last->len == start &&
+	    start != info->region_start) {
+		last->len += end + 1 - start;
+		return 0;
+	}
 
-	msg_cdbg("E");
-	if (erasefn(flashctx, info->erase_start, erase_len))
-		return 1;
-	if (check_erased_range(flashctx, info->erase_start, erase_len)) {
-		msg_cerr("ERASE FAILED!\n");
-		return 1;
+	if (reads->count == reads->capacity) {
+		const size_t capacity = reads->capacity ? 2 * reads->capacity : 16;
+		struct suspend_range *const ranges = realloc(reads->ranges, capacity * sizeof(*ranges));
+		if (!ranges) {
+			msg_gerr("Out of memory!\n");
+			return 1;
+		}
+		reads->ranges = ranges;
+		reads->capacity = capacity;
 	}
+	reads->ranges[reads->count].start = start;
+	reads->ranges[reads->count].len = end + 1 - start;
+	++reads->count;
 	return 0;
 }
 
-/**
- * @brief Erases the included layout regions.
- *
- * If there is no layout set in the given flash context, the whole chip will
- * be erased.
- *
- * @param flashctx Flash context to be used.
- * @param buffer   Buffer of full chip size to read into.
- * @return 0 on success,
- *	   1 if all available erase functions failed.
+/* Returns how many bytes at the start of a region were verified while erases were suspended. */
+static chipsize_t suspend_reads_verified(const struct suspend_reads *const reads, const chipoff_t region_start)
+{
+	chipoff_t end = region_start;
+	size_t i;
+
+	if (!reads)
+		return 0;
+	/* Follow the contiguous ranges from the start of the region. */
+	for (i = 0; i < reads->count; ++i) {
+		const struct suspend_range *const range = &reads->ranges[i];
+		if (range->start != end) {
+			if (end != region_start)
+				break;
+			continue;
+		}
+		const chipsize_t verified = i < reads->head ? range->len : i == reads->head ? reads->done : 0;
+		end += verified;
+		if (verified < range->len)
+			break;
+	}
+	return end - region_start;
+}
+
+/* Reads back the next chunk of written data. The erase has to be suspended. */
+static int verify_suspend_read(struct flashctx *const flashctx, struct suspend_reads *const reads)
+{
+	const struct suspend_range *const range = &reads->ranges[reads->head];
+	const chipoff_t start = range->start + reads->done;
+	const chipsize_t len = min(SUSPEND_READ_SIZE, range->len - reads->done);
+	uint8_t buf[SUSPEND_READ_SIZE];
+
+	if (flashctx->chip->read(flashctx, buf, start, len))
+		return 1;
+	if (memcmp(buf, reads->newcontents + start, len)) {
+		/* The final verification will report and repair it. */
+		reads->stop = true;
+		return 0;
+	}
+	reads->done += len;
+	if (reads->done == range->len) {
+		++reads->head;
+		reads->done = 0;
+	}
+	return 0;
+}
+
+/*
+ * Starts an erase without waiting for it. While the chip is busy, the erase
+ * is suspended now and then to read back blocks written before, so the
+ * final verification can skip them. The chip database tells how long the
+ * erase has to run between two suspends, and how often it may be suspended.
+ */
+static int erase_block_suspending(struct flashctx *const flashctx, struct suspend_reads *const reads,
+				  const erasefn_t erasefn, const chipoff_t erase_start, const chipsize_t erase_len)
+{
+	const struct erase_suspend *const timing = &flashctx->chip->erase_suspend;
+	unsigned int suspends = 0;
+	size_t i;
+	int busy;
+
+	/* Blocks that are erased again (e.g. shared by regions) can't count as verified. */
+	for (i = 0; i < reads->count; ++i) {
+		const struct suspend_range *const range = &reads->ranges[i];
+		if (range->start < erase_start + erase_len && erase_start < range->start + range->len) {
+			reads->head = 0;
+			reads->done = 0;
+			reads->stop = true;
+			break;
+		}
+	}
+
+	flashctx->defer_wip = true;
+	const int ret = erasefn(flashctx, erase_start, erase_len);
+	flashctx->defer_wip = false;
+	if (ret)
+		return ret;
+
+	while ((busy = spi_die_busy(flashctx, 0)) == 1) {
+		/* Nothing to read or suspended often enough, poll less often. */
+		if (reads->stop || reads->head == reads->count || suspends == timing->max_count) {
+			programmer_delay(max(timing->interval, 1000));
+			continue;
+		}
+
+		/* Let the erase make progress between suspends. */
+		programmer_delay(timing->interval);
+
+		if (spi_erase_suspend(flashctx))
+			return 1;
+		++suspends;
+		const int read_ret = verify_suspend_read(flashctx, reads);
+		if (spi_erase_resume(flashctx) || read_ret)
+			return 1;
+	}
+	return busy < 0;
+}
+
+static int erase_block(struct flashctx *const flashctx,
+		       const struct walk_info *const info, const erasefn_t erasefn)
+{
+	const unsigned int erase_len = info->erase_end + 1 - info->erase_start;
+
+	all_skipped = false;
+
+	msg_cdbg("E");
+	if (info->reads) {
+		if (erase_block_suspending(flashctx, info->reads, erasefn, info->erase_start, erase_len))
+			return 1;
+	} else if (erasefn(flashctx, info->erase_start, erase_len)) {
+		return 1;
+	}
+	if (check_erased_range(flashctx, info->erase_start, erase_len)) {
+		msg_cerr("ERASE FAILED!\n");
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Erases the included layout regions.
+ *
+ * If there is no layout set in the given flash context, the whole chip will
+ * be erased.
+ *
+ * @param flashctx Flash context to be used.
+ * @param buffer   Buffer of full chip size to read into.
+ * @return 0 on success,
+ *	   1 if all available erase functions failed.
  */
 static int erase_by_layout(struct flashctx *const flashctx)
 {
 	struct walk_info info = { 0 };
+
+	if (flashctx->chip->dies > 1) {
+		struct die_sched sched = { 0 };
+		info.sched = &sched;
+		const int ret = walk_by_layout(flashctx, &info, &plan_die_job);
+		free_die_sched(&sched);
+		return ret;
+	}
 	return walk_by_layout(flashctx, &info, &erase_block);
 }
 
@@ -1801,6 +2427,9 @@ static int read_erase_write_block(struct flashctx *const flashctx,
 	memcpy(curcontents, newcontents, erase_len);
 	ret = 0;
 
+	if (info->reads && queue_suspend_read(info->reads, info))
+		ret = 2;
+
 _free_ret:
 	if (region_unaligned)
 		free((void *)newcontents);
@@ -1816,18 +2445,187 @@ _free_ret:
  * @param flashctx    Flash context to be used.
  * @param curcontents A buffer of full chip size with current chip contents of included regions.
  * @param newcontents The new image to be written.
+ * @param reads       If not NULL, collects the written blocks that were read back
+ *                    while erases were suspended.
  * @return 0 on success,
  *	   1 if anything has gone wrong.
  */
-static int write_by_layout(struct flashctx *const flashctx,
-			   void *const curcontents, const void *const newcontents)
+static int write_by_layout(struct flashctx *const flashctx, void *const curcontents,
+			   const void *const newcontents, struct suspend_reads *const reads)
 {
-	struct walk_info info;
+	struct walk_info info = { 0 };
 	info.curcontents = curcontents;
 	info.newcontents = newcontents;
+	info.reads = reads;
+
+	if (flashctx->chip->dies > 1) {
+		struct die_sched sched = { 0 };
+		info.sched = &sched;
+		const int ret = walk_by_layout(flashctx, &info, plan_die_job);
+		free_die_sched(&sched);
+		return ret;
+	}
 	return walk_by_layout(flashctx, &info, read_erase_write_block);
 }
 
+static int stream_write_block(struct flashctx *const flashctx,
+			      const struct walk_info *const info, const erasefn_t erasefn)
+{
+	struct stream_info *const stream = info->stream;
+	const chipsize_t erase_len = info->erase_end + 1 - info->erase_start;
+	/* The part of this erase block that belongs to the current region. */
+	const chipoff_t start = info->region_start > info->erase_start ? info->region_start : info->erase_start;
+	const chipoff_t end = info->region_end < info->erase_end ? info->region_end : info->erase_end;
+	uint8_t *const curcontents = stream->curcontents;
+	uint8_t *const newcontents = stream->newcontents;
+
+	if (flashctx->chip->read(flashctx, curcontents, info->erase_start, erase_len)) {
+		msg_cerr("Can't read! Aborting.\n");
+		return 2;
+	}
+
+	/* Keep the flash contents outside the region, pull the rest from the source. */
+	memcpy(newcontents, curcontents, erase_len);
+	if (stream->source(stream->data, start, newcontents + (start - info->erase_start), end - start + 1)) {
+		msg_cerr("Can't get image data for 0x%06x-0x%06x! Aborting.\n", start, end);
+		return 2;
+	}
+
+	bool skipped = true;
+	if (need_erase(curcontents, newcontents, erase_len, flashctx->chip->gran)) {
+		if (erase_block(flashctx, info, erasefn))
+			return 1;
+		/* Erase was successful. Adjust curcontents. */
+		memset(curcontents, 0xff, erase_len);
+		skipped = false;
+	}
+
+	unsigned int starthere = 0, lenhere = 0, writecount = 0;
+	/* get_next_write() sets starthere to a new value after the call. */
+	while ((lenhere = get_next_write(curcontents + starthere, newcontents + starthere,
+					 erase_len - starthere, &starthere, flashctx->chip->gran))) {
+		if (!writecount++)
+			msg_cdbg("W");
+		if (flashctx->chip->write(flashctx, newcontents + starthere,
+					  info->erase_start + starthere, lenhere))
+			return 1;
+		starthere += lenhere;
+		skipped = false;
+	}
+	if (skipped) {
+		msg_cdbg("S");
+		return 0;
+	}
+	all_skipped = false;
+
+	/* The image is gone after this block, so verify it right away. */
+	if (stream->verify) {
+		msg_cdbg("V");
+		if (flashctx->chip->read(flashctx, curcontents, info->erase_start, erase_len)) {
+			msg_cerr("Can't read! Aborting.\n");
+			return 2;
+		}
+		if (memcmp(curcontents, newcontents, erase_len)) {
+			msg_cerr("VERIFY FAILED in 0x%06x-0x%06x!\n", info->erase_start, info->erase_end);
+			stream->verify_failed = true;
+			return 2;
+		}
+	}
+	return 0;
+}
+
+static unsigned int max_eraseblock_size(const struct block_eraser *const eraser)
+{
+	unsigned int i, size = 0;
+
+	for (i = 0; i < NUM_ERASEREGIONS; ++i) {
+		if (eraser->eraseblocks[i].count && eraser->eraseblocks[i].size > size)
+			size = eraser->eraseblocks[i].size;
+	}
+	return size;
+}
+
+/**
+ * @brief Writes the included layout regions from a source callback.
+ *
+ * Unlike walk_by_layout(), this tries the erase functions with the smallest
+ * blocks first, since only two erase blocks are held in memory at a time.
+ *
+ * @param flashctx Flash context to be used.
+ * @param stream   The source and settings for the write.
+ * @return 0 on success,
+ *	   1 if anything has gone wrong.
+ */
+static int stream_by_layout(struct flashctx *const flashctx, struct stream_info *const stream)
+{
+	const struct flashrom_layout *const layout = get_layout(flashctx);
+	struct walk_info info = { 0 };
+	unsigned int buffer_size = 0;
+	int error = 0;
+
+	info.stream = stream;
+	all_skipped = true;
+	msg_cinfo("Erasing and writing flash chip... ");
+
+	size_t i;
+	for (i = 0; i < layout->num_entries && !error; ++i) {
+		if (!layout->entries[i].included)
+			continue;
+
+		info.region_start = layout->entries[i].start;
+		info.region_end   = layout->entries[i].end;
+
+		size_t j;
+		error = 1; /* retry as long as it's 1 */
+		for (j = 0; j < NUM_ERASEFUNCTIONS; ++j) {
+			if (j != 0)
+				msg_cinfo("Looking for another erase function.\n");
+			msg_cdbg("Trying erase function %zi... ", j);
+			if (check_block_eraser(flashctx, j, 1))
+				continue;
+			if (eraser_hits_protection(flashctx, &info, j)) {
+				msg_cdbg("would erase protected blocks. ");
+				continue;
+			}
+
+			const unsigned int size = max_eraseblock_size(&flashctx->chip->block_erasers[j]);
+			if (size > buffer_size) {
+				free(stream->curcontents);
+				free(stream->newcontents);
+				stream->curcontents = malloc(size);
+				stream->newcontents = malloc(size);
+				if (!stream->curcontents || !stream->newcontents) {
+					msg_cerr("Out of memory!\n");
+					buffer_size = 0;
+					error = 2;
+					break;
+				}
+				buffer_size = size;
+			}
+
+			error = walk_eraseblocks(flashctx, &info, j, stream_write_block);
+			if (error != 1)
+				break;
+		}
+		if (error == 1)
+			msg_cinfo("No usable erase functions left.\n");
+		if (error)
+			msg_cerr("FAILED!\n");
+	}
+
+	free(stream->curcontents);
+	free(stream->newcontents);
+	stream->curcontents = NULL;
+	stream->newcontents = NULL;
+	if (error)
+		return 1;
+
+	if (all_skipped)
+		msg_cinfo("\nWarning: Chip content is identical to the requested image.\n");
+	msg_cinfo("Erase/write done.\n");
+	return 0;
+}
+
 /**
  * @brief Compares the included layout regions with content from a buffer.
  *
@@ -1837,30 +2635,185 @@ static int write_by_layout(struct flashctx *const flashctx,
  * @param flashctx    Flash context to be used.
  * @param curcontents A buffer of full chip size to read current chip contents into.
  * @param newcontents The new image to compare to.
+ * @param verified    If not NULL, the ranges that were verified while erases
+ *                    were suspended. They are skipped.
  * @return 0 on success,
  *	   1 if reading failed,
  *	   3 if the contents don't match.
  */
-static int verify_by_layout(struct flashctx *const flashctx,
-			    void *const curcontents, const uint8_t *const newcontents)
+static int verify_by_layout(struct flashctx *const flashctx, void *const curcontents,
+			    const uint8_t *const newcontents, const struct suspend_reads *const verified)
 {
 	const struct flashrom_layout *const layout = get_layout(flashctx);
+	int ret = 0;
 
 	size_t i;
 	for (i = 0; i < layout->num_entries; ++i) {
 		if (!layout->entries[i].included)
 			continue;
 
-		const chipoff_t region_start	= layout->entries[i].start;
-		const chipsize_t region_len	= layout->entries[i].end - layout->entries[i].start + 1;
+		const chipsize_t skip = suspend_reads_verified(verified, layout->entries[i].start);
+		const chipoff_t region_start	= layout->entries[i].start + skip;
+		const chipsize_t region_len	= layout->entries[i].end - region_start + 1;
 
+		if (skip)
+			msg_cdbg("0x%06x-0x%06x was verified while erases were suspended.\n",
+				 layout->entries[i].start, region_start - 1);
+		if (!region_len)
+			continue;
 		if (flashctx->chip->read(flashctx, curcontents + region_start, region_start, region_len))
 			return 1;
+		/* Keep reading, a repair needs the contents of all regions. */
 		if (compare_range(newcontents + region_start, curcontents + region_start,
 				  region_start, region_len))
-			return 3;
+			ret = 3;
 	}
-	return 0;
+	return ret;
+}
+
+static int repair_block(struct flashctx *const flashctx,
+			const struct walk_info *const info, const erasefn_t erasefn)
+{
+	struct repair_stats *const stats = info->repair;
+	const chipsize_t erase_len = info->erase_end + 1 - info->erase_start;
+	/* The part of this erase block that belongs to the current region. */
+	const chipoff_t start = info->region_start > info->erase_start ? info->region_start : info->erase_start;
+	const chipoff_t end = info->region_end < info->erase_end ? info->region_end : info->erase_end;
+	int ret = 2;
+
+	if (!memcmp(info->curcontents + start, info->newcontents + start, end - start + 1)) {
+		msg_cdbg("S");
+		return 0;
+	}
+	stats->blocks++;
+
+	uint8_t *const newcontents = malloc(erase_len);
+	uint8_t *const readback = malloc(erase_len);
+	if (!newcontents || !readback) {
+		msg_cerr("Out of memory!\n");
+		goto _free_ret;
+	}
+
+	/* Keep the flash contents outside the region, we have no other copy of them. */
+	if (flashctx->chip->read(flashctx, newcontents, info->erase_start, erase_len)) {
+		msg_cerr("Can't read! Aborting.\n");
+		goto _free_ret;
+	}
+	memcpy(newcontents + (start - info->erase_start), info->newcontents + start, end - start + 1);
+
+	unsigned int attempt;
+	bool repaired = false;
+	for (attempt = 1; attempt <= REPAIR_MAX_ATTEMPTS && !repaired; ++attempt) {
+		stats->attempts++;
+		stats->erased += erase_len;
+		if (erase_block(flashctx, info, erasefn))
+			continue;
+
+		unsigned int starthere = 0, lenhere = 0;
+		bool write_failed = false;
+		memset(readback, 0xff, erase_len);
+		msg_cdbg("W");
+		/* get_next_write() sets starthere to a new value after the call. */
+		while ((lenhere = get_next_write(readback + starthere, newcontents + starthere,
+						 erase_len - starthere, &starthere, flashctx->chip->gran))) {
+			if (flashctx->chip->write(flashctx, newcontents + starthere,
+						  info->erase_start + starthere, lenhere)) {
+				write_failed = true;
+				break;
+			}
+			starthere += lenhere;
+		}
+		if (write_failed)
+			continue;
+
+		if (flashctx->chip->read(flashctx, readback, info->erase_start, erase_len)) {
+			msg_cerr("Can't read! Aborting.\n");
+			goto _free_ret;
+		}
+		repaired = !memcmp(readback, newcontents, erase_len);
+	}
+	--attempt;
+
+	if (repaired) {
+		stats->repaired++;
+		/* Other regions with overlapping erase blocks might rely on this. */
+		memcpy(info->curcontents + info->erase_start, newcontents, erase_len);
+		msg_cinfo("\nRepaired 0x%06x-0x%06x after %u attempt%s. ",
+			  info->erase_start, info->erase_end, attempt, attempt == 1 ? "" : "s");
+	} else {
+		msg_cerr("\nCould not repair 0x%06x-0x%06x in %u attempts. ",
+			 info->erase_start, info->erase_end, attempt);
+	}
+	ret = 0;
+
+_free_ret:
+	free(readback);
+	free(newcontents);
+	return ret;
+}
+
+/**
+ * @brief Rewrites the erase blocks of included regions that failed verification.
+ *
+ * Only blocks whose contents in `curcontents` differ from `newcontents`
+ * are erased and written again, up to REPAIR_MAX_ATTEMPTS times each,
+ * and verified right away. The erase function with the smallest blocks
+ * is used to keep the rewritten range small.
+ *
+ * @param flashctx    Flash context to be used.
+ * @param curcontents A buffer of full chip size with the read back contents of included regions.
+ * @param newcontents The image that was written.
+ * @return 0 if all mismatching blocks were repaired,
+ *	   3 if some blocks still don't match,
+ *	   1 on any other error.
+ */
+static int repair_by_layout(struct flashctx *const flashctx,
+			    uint8_t *const curcontents, const uint8_t *const newcontents)
+{
+	const struct flashrom_layout *const layout = get_layout(flashctx);
+	struct repair_stats stats = { 0 };
+	struct walk_info info = { 0 };
+	info.curcontents = curcontents;
+	info.newcontents = newcontents;
+	info.repair = &stats;
+
+	msg_cinfo("Repairing mismatching blocks... ");
+
+	size_t i;
+	for (i = 0; i < layout->num_entries; ++i) {
+		if (!layout->entries[i].included)
+			continue;
+
+		info.region_start = layout->entries[i].start;
+		info.region_end   = layout->entries[i].end;
+
+		/* Like stream_by_layout(), prefer the smallest blocks. */
+		size_t j, best = NUM_ERASEFUNCTIONS;
+		unsigned int best_size = 0;
+		for (j = 0; j < NUM_ERASEFUNCTIONS; ++j) {
+			if (check_block_eraser(flashctx, j, 0) || eraser_hits_protection(flashctx, &info, j))
+				continue;
+			const unsigned int size = max_eraseblock_size(&flashctx->chip->block_erasers[j]);
+			if (best == NUM_ERASEFUNCTIONS || size < best_size) {
+				best = j;
+				best_size = size;
+			}
+		}
+		if (best == NUM_ERASEFUNCTIONS) {
+			msg_cerr("No usable erase function!\n");
+			return 1;
+		}
+		msg_cdbg("\nUsing erase function %zu with blocks of up to %u bytes for \"%s\". ",
+			 best, best_size, layout->entries[i].name);
+		if (walk_eraseblocks(flashctx, &info, best, repair_block)) {
+			msg_cerr("FAILED!\n");
+			return 1;
+		}
+	}
+
+	msg_cinfo("\nRepaired %u of %u mismatching blocks with %u erase/write attempts of %lu bytes.\n",
+		  stats.repaired, stats.blocks, stats.attempts, stats.erased);
+	return stats.repaired == stats.blocks ? 0 : 3;
 }
 
 static void nonfatal_help_message(void)
@@ -2195,26 +3148,208 @@ int chip_safety_check(const struct flashctx *flash, int force, int read_it, int
 	return 0;
 }
 
-int prepare_flash_access(struct flashctx *const flash,
-			 const bool read_it, const bool write_it,
-			 const bool erase_it, const bool verify_it)
+static int unprotect_range(struct flashctx *const flash, const struct protected_range *const range)
 {
-	if (chip_safety_check(flash, flash->flags.force, read_it, write_it, erase_it, verify_it)) {
-		msg_cerr("Aborting.\n");
-		return 1;
-	}
+	if (flash->chip->unprotect)
+		return flash->chip->unprotect(flash, range->start, range->len);
+	if (flash->chip->unlock)
+		return flash->chip->unlock(flash);
+	return 1;
+}
 
-	if (flash->layout == get_global_layout() && normalize_romentries(flash)) {
-		msg_cerr("Requested regions can not be handled. Aborting.\n");
-		return 1;
-	}
+/* Lifts read locks, everything else is left to plan_protection(). */
+static void unprotect_reads(struct flashctx *const flash)
+{
+	struct protection prot;
+	size_t i;
 
-	if (map_flash(flash) != 0)
-		return 1;
+	if (flash->chip->protection(flash, &prot)) {
+		msg_cwarn("Can't read the protection state of the chip.\n");
+		return;
+	}
+	for (i = 0; i < prot.count; ++i) {
+		const struct protected_range *const range = &prot.ranges[i];
+		if (!range->read)
+			continue;
+		if (range->fixed || unprotect_range(flash, range))
+			msg_cwarn("0x%06x-0x%06x is read protected and reads will fail.\n",
+				  range->start, range->start + range->len - 1);
+	}
+}
+
+/* Returns true if the included region `i` can be erased around the ranges in flash->protection. */
+static bool region_erasable(struct flashctx *const flash, const uint8_t *const curcontents,
+			    const uint8_t *const newcontents, const size_t i)
+{
+	const struct flashrom_layout *const layout = get_layout(flash);
+	const struct walk_info info = {
+		.curcontents	= (uint8_t *)curcontents,
+		.newcontents	= newcontents,
+		.region_start	= layout->entries[i].start,
+		.region_end	= layout->entries[i].end,
+	};
+	size_t k;
+
+	for (k = 0; k < NUM_ERASEFUNCTIONS; ++k) {
+		if (!check_block_eraser(flash, k, 0) && !eraser_hits_protection(flash, &info, k))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Decides how the protection of the chip affects the following erase or write,
+ * before anything is touched: Protected ranges the operation doesn't change are
+ * left protected. The others are unprotected, and so are ranges that share all
+ * usable erase blocks with a change. If a range that has to go can't be
+ * unprotected, the operation is refused. The decisions are reported.
+ *
+ * `curcontents` and `newcontents` may be NULL if everything included changes.
+ * The ranges that stay protected are left in flash->protection, walk_by_layout()
+ * avoids erase functions that would touch them.
+ *
+ * Chips without a protection decoder were unlocked by prepare_chip_access().
+ *
+ * Returns 0 to go ahead, 1 if the operation has to be refused.
+ */
+static int plan_protection(struct flashctx *const flash, const uint8_t *const curcontents,
+			   const uint8_t *const newcontents)
+{
+	const struct flashrom_layout *const layout = get_layout(flash);
+	const chipsize_t gap = smallest_eraseblock(flash->chip);
+	struct protection *const prot = &flash->protection;
+	bool unprotected = false;
+	size_t i, j;
+
+	prot->count = 0;
+	if (!flash->chip->protection)
+		return 0;
+	if (flash->chip->protection(flash, prot)) {
+		msg_cerr("Can't read the protection state of the chip, refusing to change it.\n");
+		prot->count = 0;
+		return 1;
+	}
+
+	/* Everything that changes has to be unprotected, the rest stays. */
+	for (i = 0; i < prot->count; ++i) {
+		const struct protected_range *const range = &prot->ranges[i];
+		const chipoff_t end = range->start + range->len - 1;
+		if (range->fixed && range_changes(flash, curcontents, newcontents, range->start, end)) {
+			msg_cerr("Protection: 0x%06x-0x%06x has to change but can't be unprotected.\n",
+				 range->start, end);
+			goto _refuse;
+		}
+	}
+	for (i = 0; i < prot->count; ++i) {
+		const struct protected_range *const range = &prot->ranges[i];
+		const chipoff_t end = range->start + range->len - 1;
+		if (!range_changes(flash, curcontents, newcontents, range->start, end)) {
+			msg_cinfo("Protection: 0x%06x-0x%06x doesn't change and stays protected.\n",
+				  range->start, end);
+			continue;
+		}
+		/*
+		 * Chips may protect in smaller units than this range, so only
+		 * unprotect the runs of changes, one at a time. Chips that can
+		 * only be unlocked as a whole are unlocked once.
+		 */
+		struct protected_range changed = *range;
+		chipoff_t first = range->start, last = end;
+		while (first <= end) {
+			last = end;
+			if (flash->chip->unprotect &&
+			    !changed_run(flash, curcontents, newcontents, gap, &first, &last))
+				break;
+			changed.start = first;
+			changed.len = last + 1 - first;
+			msg_cinfo("Protection: Unprotecting 0x%06x-0x%06x of 0x%06x-0x%06x.\n",
+				  first, last, range->start, end);
+			if (unprotect_range(flash, &changed)) {
+				msg_cerr("Protection: Unprotecting 0x%06x-0x%06x failed.\n", first, last);
+				goto _refuse;
+			}
+			if (last == end)
+				break;
+			first = last + 1;
+		}
+		unprotected = true;
+	}
+
+	/* Unprotecting may change more than asked for, see what is left. */
+	if (unprotected && flash->chip->protection(flash, prot)) {
+		msg_cerr("Can't read the protection state of the chip.\n");
+		goto _refuse;
+	}
+	unprotected = false;
+	for (i = 0; i < prot->count; ++i) {
+		const struct protected_range *const range = &prot->ranges[i];
+		if (range_changes(flash, curcontents, newcontents, range->start, range->start + range->len - 1)) {
+			msg_cerr("Protection: 0x%06x-0x%06x is still protected.\n",
+				 range->start, range->start + range->len - 1);
+			goto _refuse;
+		}
+	}
+
+	/* Every region needs an erase function that stays clear of protected blocks. */
+	for (i = 0; i < layout->num_entries; ++i) {
+		if (!layout->entries[i].included || region_erasable(flash, curcontents, newcontents, i))
+			continue;
+		for (j = 0; j < prot->count; ++j) {
+			const struct protected_range *const range = &prot->ranges[j];
+			const chipoff_t end = range->start + range->len - 1;
+			if (end < layout->entries[i].start || layout->entries[i].end < range->start)
+				continue;
+			if (range->fixed) {
+				msg_cerr("Protection: Erasing \"%s\" would touch 0x%06x-0x%06x, "
+					 "which can't be unprotected.\n", layout->entries[i].name, range->start, end);
+				goto _refuse;
+			}
+			msg_cinfo("Protection: Unprotecting 0x%06x-0x%06x, it shares erase blocks with \"%s\".\n",
+				  range->start, end, layout->entries[i].name);
+			if (unprotect_range(flash, range)) {
+				msg_cerr("Protection: Unprotecting 0x%06x-0x%06x failed.\n", range->start, end);
+				goto _refuse;
+			}
+			unprotected = true;
+		}
+		if (unprotected && flash->chip->protection(flash, prot)) {
+			msg_cerr("Can't read the protection state of the chip.\n");
+			goto _refuse;
+		}
+		unprotected = false;
+		if (!region_erasable(flash, curcontents, newcontents, i)) {
+			msg_cerr("Protection: No erase function for \"%s\" avoids protected blocks.\n",
+				 layout->entries[i].name);
+			goto _refuse;
+		}
+	}
+	return 0;
+
+_refuse:
+	msg_cerr("Refusing to erase or write, the flash contents were not changed.\n");
+	prot->count = 0;
+	return 1;
+}
+
+/* Maps the flash and brings the chip into a state to be accessed. */
+static int prepare_chip_access(struct flashctx *const flash)
+{
+	if (map_flash(flash) != 0)
+		return 1;
 
 	/* Given the existence of read locks, we want to unlock for read,
 	   erase and write. */
-	if (flash->chip->unlock)
+	flash->selected_die = -1;
+	flash->busy_dies = 0;
+	flash->defer_wip = false;
+	flash->protection.count = 0;
+	flash->locks_valid = false;
+
+	/* Chips that can tell what is protected are only unlocked as far as
+	   needed, see plan_protection(). */
+	if (flash->chip->protection)
+		unprotect_reads(flash);
+	else if (flash->chip->unlock)
 		flash->chip->unlock(flash);
 
 	flash->address_high_byte = -1;
@@ -2233,11 +3368,41 @@ int prepare_flash_access(struct flashctx *const flash,
 		}
 	}
 
+	if (spi_prepare_io_mode(flash)) {
+		msg_cerr("Failed to set up the I/O mode! Aborting.\n");
+		return 1;
+	}
+
 	return 0;
 }
 
+int prepare_flash_access(struct flashctx *const flash,
+			 const bool read_it, const bool write_it,
+			 const bool erase_it, const bool verify_it)
+{
+	if (chip_safety_check(flash, flash->flags.force, read_it, write_it, erase_it, verify_it)) {
+		msg_cerr("Aborting.\n");
+		return 1;
+	}
+
+	if (flash->layout == get_global_layout() && normalize_romentries(flash)) {
+		msg_cerr("Requested regions can not be handled. Aborting.\n");
+		return 1;
+	}
+
+	/* Within a session, the chip is already prepared. */
+	if (flash->in_session)
+		return 0;
+
+	return prepare_chip_access(flash);
+}
+
 void finalize_flash_access(struct flashctx *const flash)
 {
+	if (flash->in_session)
+		return;
+
+	spi_finalize_io_mode(flash);
 	unmap_flash(flash);
 }
 
@@ -2246,6 +3411,52 @@ void finalize_flash_access(struct flashctx *const flash)
  * @{
  */
 
+/**
+ * @brief Begin a session of operations on a flash chip.
+ *
+ * Every operation has to map the flash, unlock the chip and set up its
+ * addressing mode before it can access it. Within a session, this is
+ * done only once, when the session begins, and undone when it ends.
+ * The safety checks for each operation are still performed.
+ *
+ * @param flashctx The context of the flash chip to access.
+ * @return 0 on success,
+ *         1 if the chip can't be accessed or a session is already active.
+ */
+int flashrom_session_begin(struct flashctx *const flashctx)
+{
+	if (flashctx->in_session) {
+		msg_gerr("A session is already active for this flash chip.\n");
+		return 1;
+	}
+
+	/* Every operation needs read. */
+	if (chip_safety_check(flashctx, flashctx->flags.force, true, false, false, false)) {
+		msg_cerr("Aborting.\n");
+		return 1;
+	}
+
+	if (prepare_chip_access(flashctx))
+		return 1;
+
+	flashctx->in_session = true;
+	return 0;
+}
+
+/**
+ * @brief End the session begun with flashrom_session_begin().
+ *
+ * @param flashctx The context of the flash chip.
+ */
+void flashrom_session_end(struct flashctx *const flashctx)
+{
+	if (!flashctx->in_session)
+		return;
+
+	flashctx->in_session = false;
+	finalize_flash_access(flashctx);
+}
+
 /**
  * @brief Erase the specified ROM chip.
  *
@@ -2253,14 +3464,18 @@ void finalize_flash_access(struct flashctx *const flash)
  * will be erased.
  *
  * @param flashctx The context of the flash chip to erase.
- * @return 0 on success.
+ * @return 0 on success,
+ *         2 if the erase was refused because of write protection,
+ *         or 1 on any other failure.
  */
 int flashrom_flash_erase(struct flashctx *const flashctx)
 {
 	if (prepare_flash_access(flashctx, false, false, true, false))
 		return 1;
 
-	const int ret = erase_by_layout(flashctx);
+	int ret = 2;
+	if (!plan_protection(flashctx, NULL, NULL))
+		ret = erase_by_layout(flashctx);
 
 	finalize_flash_access(flashctx);
 
@@ -2274,12 +3489,21 @@ int flashrom_flash_erase(struct flashctx *const flashctx)
  * @{
  */
 
+static int copy_chunk_to_buffer(void *const data, const size_t offset, const void *const buf, const size_t len)
+{
+	memcpy((uint8_t *)data + offset, buf, len);
+	return 0;
+}
+
 /**
  * @brief Read the current image from the specified ROM chip.
  *
  * If a layout is set in the specified flash context, only included regions
  * will be read.
  *
+ * With FLASHROM_FLAG_CONSISTENT_READ, the read is checked like described
+ * for flashrom_image_read_stream().
+ *
  * @param flashctx The context of the flash chip.
  * @param buffer Target buffer to write image to.
  * @param buffer_len Size of target buffer in bytes.
@@ -2294,6 +3518,9 @@ int flashrom_image_read(struct flashctx *const flashctx, void *const buffer, con
 	if (flash_size > buffer_len)
 		return 2;
 
+	if (flashctx->flags.consistent_read)
+		return flashrom_image_read_stream(flashctx, copy_chunk_to_buffer, buffer);
+
 	if (prepare_flash_access(flashctx, true, false, false, false))
 		return 1;
 
@@ -2313,6 +3540,180 @@ _finalize_ret:
 	return ret;
 }
 
+/* Prints the range of unstable blocks in `run`, if any, and resets it. */
+static void report_unstable_range(chipoff_t run[2])
+{
+	if (run[1] < run[0])
+		return;
+	msg_cwarn("\nReads of 0x%06x-0x%06x were unstable. ", run[0], run[1]);
+	run[0] = 1;
+	run[1] = 0;
+}
+
+/*
+ * Reads the included regions a second time and compares the hashes of
+ * each CONSISTENT_READ_BLOCK with the ones recorded in the first pass.
+ * Blocks that differ are read again until two reads in a row agree,
+ * and are then passed to the sink again.
+ */
+static int check_read_consistency(struct flashctx *const flashctx, uint8_t *const buf,
+				  const uint64_t *const hashes, flashrom_sink_callback *const sink, void *const data)
+{
+	const struct flashrom_layout *const layout = get_layout(flashctx);
+	chipoff_t run[2] = { 1, 0 };
+	size_t i, k = 0, unstable = 0;
+	int ret = 1;
+
+	msg_cinfo("Reading flash again to check consistency... ");
+	for (i = 0; i < layout->num_entries; ++i) {
+		const struct romentry *const entry = &layout->entries[i];
+		if (!entry->included)
+			continue;
+
+		chipoff_t start;
+		for (start = entry->start; start <= entry->end; start += STREAM_CHUNK_SIZE) {
+			const chipsize_t chunk = min(STREAM_CHUNK_SIZE, entry->end - start + 1);
+			if (flashctx->chip->read(flashctx, buf, start, chunk)) {
+				msg_cerr("Read operation failed!\n");
+				goto _out;
+			}
+
+			chipsize_t off;
+			for (off = 0; off < chunk; off += CONSISTENT_READ_BLOCK) {
+				const chipsize_t len = min(CONSISTENT_READ_BLOCK, chunk - off);
+				uint64_t last = fnv1a_64(buf + off, len);
+				if (last == hashes[k++])
+					continue;
+
+				unsigned int attempt;
+				bool stable = false;
+				for (attempt = 0; attempt < CONSISTENT_READ_RETRIES && !stable; ++attempt) {
+					if (flashctx->chip->read(flashctx, buf + off, start + off, len)) {
+						msg_cerr("Read operation failed!\n");
+						goto _out;
+					}
+					const uint64_t hash = fnv1a_64(buf + off, len);
+					stable = hash == last || hash == hashes[k - 1];
+					last = hash;
+				}
+
+				unstable += len;
+				if (run[1] + 1 != start + off)
+					report_unstable_range(run);
+				if (run[1] < run[0])
+					run[0] = start + off;
+				run[1] = start + off + len - 1;
+
+				if (!stable) {
+					report_unstable_range(run);
+					msg_cerr("\nReads of 0x%06x-0x%06x didn't agree in %u reads!\n",
+						 start + off, start + off + len - 1, CONSISTENT_READ_RETRIES + 2);
+					goto _out;
+				}
+				if (sink(data, start + off, buf + off, len))
+					goto _out;
+			}
+		}
+	}
+	report_unstable_range(run);
+	if (unstable)
+		msg_cinfo("\n%zu bytes were read again until they were consistent. ", unstable);
+	ret = 0;
+
+_out:
+	msg_cinfo("%s.\n", ret ? "FAILED" : "done");
+	return ret;
+}
+
+/**
+ * @brief Read the current image from the specified ROM chip in chunks.
+ *
+ * Like flashrom_image_read(), but instead of filling a buffer of full flash
+ * size, the contents are passed to a callback chunk by chunk. So the memory
+ * needed doesn't grow with the size of the flash chip.
+ *
+ * If FLASHROM_FLAG_CONSISTENT_READ is set, the chip is read a second time
+ * and compared by block hashes to the first read. Blocks that differ are
+ * read until two reads in a row agree and passed to the callback again.
+ *
+ * @param flashctx The context of the flash chip.
+ * @param sink     Called with the offset, data and length of each chunk,
+ *                 in ascending order per included region. A non-zero
+ *                 return value aborts the read. The same range may be
+ *                 passed again with FLASHROM_FLAG_CONSISTENT_READ.
+ * @param data     Passed through to the callback.
+ * @return 0 on success,
+ *         or 1 on any failure.
+ */
+int flashrom_image_read_stream(struct flashctx *const flashctx, flashrom_sink_callback *const sink, void *const data)
+{
+	const struct flashrom_layout *const layout = get_layout(flashctx);
+	const bool consistent = flashctx->flags.consistent_read;
+	uint64_t *hashes = NULL;
+	size_t i, k = 0;
+	int ret = 1;
+
+	if (consistent) {
+		size_t blocks = 0;
+		for (i = 0; i < layout->num_entries; ++i) {
+			if (layout->entries[i].included)
+				blocks += (layout->entries[i].end - layout->entries[i].start) /
+					  CONSISTENT_READ_BLOCK + 1;
+		}
+		hashes = malloc(blocks * sizeof(*hashes));
+		if (!hashes) {
+			msg_gerr("Out of memory!\n");
+			return 1;
+		}
+	}
+
+	uint8_t *const buf = malloc(STREAM_CHUNK_SIZE);
+	if (!buf) {
+		msg_gerr("Out of memory!\n");
+		free(hashes);
+		return 1;
+	}
+
+	if (prepare_flash_access(flashctx, true, false, false, false)) {
+		free(buf);
+		free(hashes);
+		return 1;
+	}
+
+	msg_cinfo("Reading flash... ");
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		const struct romentry *const entry = &layout->entries[i];
+		if (!entry->included)
+			continue;
+
+		chipoff_t start;
+		for (start = entry->start; start <= entry->end; start += STREAM_CHUNK_SIZE) {
+			const chipsize_t chunk = min(STREAM_CHUNK_SIZE, entry->end - start + 1);
+			if (flashctx->chip->read(flashctx, buf, start, chunk)) {
+				msg_cerr("Read operation failed!\n");
+				goto _finalize_ret;
+			}
+			if (sink(data, start, buf, chunk))
+				goto _finalize_ret;
+
+			chipsize_t off;
+			for (off = 0; consistent && off < chunk; off += CONSISTENT_READ_BLOCK)
+				hashes[k++] = fnv1a_64(buf + off, min(CONSISTENT_READ_BLOCK, chunk - off));
+		}
+	}
+	ret = 0;
+
+_finalize_ret:
+	msg_cinfo("%s.\n", ret ? "FAILED" : "done");
+	if (!ret && consistent)
+		ret = check_read_consistency(flashctx, buf, hashes, sink, data);
+	finalize_flash_access(flashctx);
+	free(buf);
+	free(hashes);
+	return ret;
+}
+
 static void combine_image_by_layout(const struct flashctx *const flashctx,
 				    uint8_t *const newcontents, const uint8_t *const oldcontents)
 {
@@ -2359,6 +3760,7 @@ int flashrom_image_write(struct flashctx *const flashctx, void *const buffer, co
 	uint8_t *const newcontents = buffer;
 	uint8_t *const curcontents = malloc(flash_size);
 	uint8_t *oldcontents = NULL;
+	struct suspend_reads reads = { .newcontents = newcontents };
 	if (verify_all)
 		oldcontents = malloc(flash_size);
 	if (!curcontents || (verify_all && !oldcontents)) {
@@ -2403,7 +3805,14 @@ int flashrom_image_write(struct flashctx *const flashctx, void *const buffer, co
 	}
 	msg_cinfo("done.\n");
 
-	if (write_by_layout(flashctx, curcontents, newcontents)) {
+	if (plan_protection(flashctx, curcontents, newcontents))
+		goto _finalize_ret;
+
+	/* Read back written blocks while later erases are suspended. */
+	const bool suspend = flashctx->flags.erase_suspend && verify &&
+			     flashctx->chip->erase_suspend.latency && flashctx->chip->dies <= 1;
+
+	if (write_by_layout(flashctx, curcontents, newcontents, suspend ? &reads : NULL)) {
 		msg_cerr("Uh oh. Erase/write failed. ");
 		ret = 2;
 		if (verify_all) {
@@ -2440,7 +3849,9 @@ int flashrom_image_write(struct flashctx *const flashctx, void *const buffer, co
 			combine_image_by_layout(flashctx, newcontents, oldcontents);
 			flashctx->layout = NULL;
 		}
-		ret = verify_by_layout(flashctx, curcontents, newcontents);
+		ret = verify_by_layout(flashctx, curcontents, newcontents, suspend ? &reads : NULL);
+		if (ret == 3)
+			ret = repair_by_layout(flashctx, curcontents, newcontents);
 		flashctx->layout = layout_bak;
 		/* If we tried to write, and verification now fails, we
 		   might have an emergency situation. */
@@ -2456,11 +3867,71 @@ int flashrom_image_write(struct flashctx *const flashctx, void *const buffer, co
 _finalize_ret:
 	finalize_flash_access(flashctx);
 _free_ret:
+	free(reads.ranges);
 	free(oldcontents);
 	free(curcontents);
 	return ret;
 }
 
+/**
+ * @brief Write an image to the ROM chip that is pulled from a callback.
+ *
+ * Like flashrom_image_write(), but the new contents are requested from the
+ * callback one erase block at a time, right before the block is written.
+ * So the memory needed only grows with the size of the erase blocks, not
+ * with the size of the flash chip. Erase functions with small blocks are
+ * preferred for that reason.
+ *
+ * If FLASHROM_FLAG_VERIFY_AFTER_WRITE is set, each block is verified right
+ * after it was written. As the image is never held completely, regions
+ * outside the layout are not verified, regardless of
+ * FLASHROM_FLAG_VERIFY_WHOLE_CHIP. Neither is the image checked for a
+ * matching mainboard.
+ *
+ * @param flashctx The context of the flash chip.
+ * @param source   Called to fill a buffer with the image data at the given
+ *                 offset and length. Offsets ascend within an included
+ *                 region, but the same range may be requested again if an
+ *                 erase function fails. A non-zero return value aborts the
+ *                 write.
+ * @param data     Passed through to the callback.
+ * @return 0 on success,
+ *         3 if verification failed,
+ *         2 if write failed and flash contents may have changed,
+ *         or 1 on any other failure.
+ */
+int flashrom_image_write_stream(struct flashctx *const flashctx, flashrom_source_callback *const source,
+				void *const data)
+{
+	struct stream_info stream = { 0 };
+	int ret;
+
+	stream.source = source;
+	stream.data = data;
+	stream.verify = flashctx->flags.verify_after_write;
+
+	if (prepare_flash_access(flashctx, false, true, false, stream.verify))
+		return 1;
+
+	ret = 0;
+	if (plan_protection(flashctx, NULL, NULL)) {
+		ret = 1;
+	} else if (stream_by_layout(flashctx, &stream)) {
+		if (stream.verify_failed) {
+			ret = 3;
+		} else {
+			msg_cerr("Uh oh. Erase/write failed.\n");
+			ret = 2;
+		}
+		emergency_help_message();
+	} else if (stream.verify && !all_skipped) {
+		msg_cinfo("VERIFIED.\n");
+	}
+
+	finalize_flash_access(flashctx);
+	return ret;
+}
+
 /**
  * @brief Verify the ROM chip's contents with the specified image.
  *
@@ -2495,7 +3966,7 @@ int flashrom_image_verify(struct flashctx *const flashctx, const void *const buf
 		goto _free_ret;
 
 	msg_cinfo("Verifying flash... ");
-	ret = verify_by_layout(flashctx, curcontents, newcontents);
+	ret = verify_by_layout(flashctx, curcontents, newcontents, NULL);
 	if (!ret)
 		msg_cinfo("VERIFIED.\n");
 
@@ -2507,22 +3978,130 @@ _free_ret:
 
 /** @} */ /* end flashrom-ops */
 
+#ifndef __LIBPAYLOAD__
+/** @private */
+struct image_file {
+	FILE *file;
+	const char *filename;
+	size_t size;
+};
+
+static int write_chunk_to_file(void *const data, const size_t offset, const void *const buf, const size_t len)
+{
+	const struct image_file *const image = data;
+
+	if (fseek(image->file, offset, SEEK_SET) || fwrite(buf, 1, len, image->file) != len) {
+		msg_gerr("Error: writing file \"%s\" failed: %s\n", image->filename, strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+static int read_chunk_from_file(void *const data, const size_t offset, void *const buf, const size_t len)
+{
+	const struct image_file *const image = data;
+	size_t numbytes = 0;
+
+	if (offset < image->size) {
+		const size_t want = len < image->size - offset ? len : image->size - offset;
+		if (fseek(image->file, offset, SEEK_SET) ||
+		    (numbytes = fread(buf, 1, want, image->file)) != want) {
+			msg_gerr("Error: reading file \"%s\" failed.\n", image->filename);
+			return 1;
+		}
+	}
+	/* Images shorter than the flash chip are padded like erased flash. */
+	memset((uint8_t *)buf + numbytes, 0xff, len - numbytes);
+	return 0;
+}
+#endif
+
 int do_read(struct flashctx *const flash, const char *const filename)
 {
-	if (prepare_flash_access(flash, true, false, false, false))
+#ifdef __LIBPAYLOAD__
+	msg_gerr("Error: No file I/O support in libpayload\n");
+	return 1;
+#else
+	const size_t flash_size = flash->chip->total_size * 1024;
+	struct stat image_stat;
+	int ret;
+
+	/*
+	 * Pipes and devices can't seek and can't be replaced, so they get the
+	 * buffered path and are only opened once the whole image was read.
+	 */
+	if (stat(filename, &image_stat) == 0 && !S_ISREG(image_stat.st_mode)) {
+		uint8_t *const buf = calloc(flash_size, 1);
+		if (!buf) {
+			msg_gerr("Memory allocation failed!\n");
+			return 1;
+		}
+		ret = flashrom_image_read(flash, buf, flash_size);
+		if (!ret)
+			ret = write_buf_to_file(buf, flash_size, filename);
+		free(buf);
+		return ret;
+	}
+
+	/*
+	 * Chunks go straight to regular files, so we never hold the whole
+	 * image. They are written to a temporary file that only replaces
+	 * the image once the read succeeded, so a failed read doesn't
+	 * destroy an older one.
+	 */
+	char *const tmpname = malloc(strlen(filename) + sizeof(".tmp"));
+	if (!tmpname) {
+		msg_gerr("Memory allocation failed!\n");
 		return 1;
+	}
+	sprintf(tmpname, "%s.tmp", filename);
 
-	const int ret = read_flash_to_file(flash, filename);
+	struct image_file image = { .filename = tmpname };
+	image.file = fopen(tmpname, "wb");
+	if (!image.file) {
+		msg_gerr("Error: opening file \"%s\" failed: %s\n", tmpname, strerror(errno));
+		free(tmpname);
+		return 1;
+	}
 
-	finalize_flash_access(flash);
+	ret = flashrom_image_read_stream(flash, write_chunk_to_file, &image);
 
+	/* Pad the file to full flash size; regions that weren't read read as 0. */
+	if (!ret && (fseek(image.file, 0, SEEK_END) || ftell(image.file) < 0)) {
+		msg_gerr("Error: seeking in file \"%s\" failed: %s\n", tmpname, strerror(errno));
+		ret = 1;
+	}
+	if (!ret && (size_t)ftell(image.file) < flash_size) {
+		const uint8_t zero = 0;
+		ret = write_chunk_to_file(&image, flash_size - 1, &zero, 1);
+	}
+
+	if (close_image_file(image.file, tmpname))
+		ret = 1;
+#ifdef _WIN32
+	/* rename() doesn't replace existing files on Windows. */
+	if (!ret)
+		(void)remove(filename);
+#endif
+	if (!ret && rename(tmpname, filename)) {
+		msg_gerr("Error: renaming \"%s\" to \"%s\" failed: %s\n", tmpname, filename, strerror(errno));
+		ret = 1;
+	}
+	if (ret)
+		(void)remove(tmpname);
+	free(tmpname);
 	return ret;
+#endif
 }
 
 int do_erase(struct flashctx *const flash)
 {
 	const int ret = flashrom_flash_erase(flash);
 
+	/* Nothing was erased, plan_protection() said why. */
+	if (ret == 2)
+		return 1;
+
 	/*
 	 * FIXME: Do we really want the scary warning if erase failed?
 	 * After all, after erase the chip is either blank or partially
@@ -2557,6 +4136,42 @@ _free_ret:
 	return ret;
 }
 
+int do_write_stream(struct flashctx *const flash, const char *const filename)
+{
+#ifdef __LIBPAYLOAD__
+	msg_gerr("Error: No file I/O support in libpayload\n");
+	return 1;
+#else
+	const size_t flash_size = flash->chip->total_size * 1024;
+	struct image_file image = { .filename = filename };
+	int ret = 1;
+
+	image.file = fopen(filename, "rb");
+	if (!image.file) {
+		msg_gerr("Error: opening file \"%s\" failed: %s\n", filename, strerror(errno));
+		return 1;
+	}
+
+	struct stat image_stat;
+	if (fstat(fileno(image.file), &image_stat) != 0) {
+		msg_gerr("Error: getting metadata of file \"%s\" failed: %s\n", filename, strerror(errno));
+		goto _close_ret;
+	}
+	if ((uintmax_t)image_stat.st_size > flash_size) {
+		msg_gerr("Error: Image size (%jd B) doesn't match the flash chip's size (%zu B)!\n",
+			 (intmax_t)image_stat.st_size, flash_size);
+		goto _close_ret;
+	}
+	image.size = image_stat.st_size;
+
+	ret = flashrom_image_write_stream(flash, read_chunk_from_file, &image);
+
+_close_ret:
+	(void)fclose(image.file);
+	return ret;
+#endif
+}
+
 int do_verify(struct flashctx *const flash, const char *const filename)
 {
 	const size_t flash_size = flash->chip->total_size * 1024;
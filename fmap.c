@@ -0,0 +1,287 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flash.h"
+#include "fmap.h"
+
+/* Smallest alignment probed when looking for the FMAP on the flash chip itself,
+   and the most probes tried before the chip is searched chunk by chunk. */
+#define FMAP_MIN_STRIDE		0x100
+#define FMAP_MAX_PROBES		64
+#define FMAP_SEARCH_CHUNK	(64 * 1024)
+
+static uint16_t fmap_le16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8;
+}
+
+static uint32_t fmap_le32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* Returns the number of areas if `hdr` is the start of a sane FMAP header, 0 otherwise. */
+static unsigned int fmap_check_header(const uint8_t *const hdr)
+{
+	if (memcmp(hdr, FMAP_SIGNATURE, FMAP_SIGNATURE_LEN))
+		return 0;
+	/* Only the major version is relevant for the format. */
+	if (hdr[FMAP_SIGNATURE_LEN] != FMAP_VER_MAJOR)
+		return 0;
+	return fmap_le16(hdr + FMAP_HEADER_LEN - 2);
+}
+
+/*
+ * Look for the first valid FMAP in `buf`.
+ *
+ * The signature starts with '_', which is rare in firmware images. So let
+ * memchr(), which the C library implements with wide vector compares, skip
+ * over everything else and only do the full comparison on candidates.
+ *
+ * Returns 0 and sets `*offset` if an FMAP was found, 1 otherwise.
+ */
+int fmap_find_in_buffer(const uint8_t *const buf, const size_t len, size_t *const offset)
+{
+	if (len < FMAP_HEADER_LEN)
+		return 1;
+
+	const uint8_t *p = buf;
+	const uint8_t *const last = buf + len - FMAP_HEADER_LEN;
+
+	while (p <= last) {
+		p = memchr(p, FMAP_SIGNATURE[0], last - p + 1);
+		if (!p)
+			break;
+		const unsigned int nareas = fmap_check_header(p);
+		if (nareas && (size_t)(last - p) >= (size_t)nareas * FMAP_AREA_LEN) {
+			*offset = p - buf;
+			return 0;
+		}
+		++p;
+	}
+	return 1;
+}
+
+/* Converts the FMAP at `fmap` (header followed by all areas) into a newly allocated layout. */
+static int fmap_to_layout(struct flashrom_layout **const layout, const uint8_t *const fmap,
+			  const chipsize_t chip_size)
+{
+	const unsigned int nareas = fmap_check_header(fmap);
+	struct fmap_layout *const l = malloc(sizeof(*l) + nareas * sizeof(l->entries[0]));
+	if (!l) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+
+	msg_gdbg("FMAP \"%.*s\" with %u areas:\n", FMAP_STRLEN,
+		 (const char *)fmap + FMAP_SIGNATURE_LEN + 2 + 8 + 4, nareas);
+
+	unsigned int i, j;
+	for (i = 0, j = 0; i < nareas; ++i) {
+		const uint8_t *const area = fmap + FMAP_HEADER_LEN + i * FMAP_AREA_LEN;
+		const uint32_t offset = fmap_le32(area);
+		const uint32_t size = fmap_le32(area + 4);
+		const char *const name = (const char *)area + 8;
+
+		if (!size) {
+			msg_gdbg("Skipping empty FMAP area \"%.*s\".\n", FMAP_STRLEN, name);
+			continue;
+		}
+		if (offset >= chip_size || size > chip_size - offset) {
+			msg_gwarn("FMAP area \"%.*s\" (0x%08x, 0x%x bytes) exceeds the flash chip, skipping it.\n",
+				  FMAP_STRLEN, name, offset, size);
+			continue;
+		}
+
+		l->entries[j].start = offset;
+		l->entries[j].end = offset + size - 1;
+		l->entries[j].included = false;
+		snprintf(l->entries[j].name, sizeof(l->entries[j].name), "%.*s", FMAP_STRLEN, name);
+		msg_gdbg("fmap %08x - %08x named %s\n", l->entries[j].start, l->entries[j].end, l->entries[j].name);
+		++j;
+	}
+
+	if (!j) {
+		msg_gerr("FMAP doesn't contain any usable area.\n");
+		free(l);
+		return 1;
+	}
+
+	l->base.entries = l->entries;
+	l->base.num_entries = j;
+	*layout = &l->base;
+	return 0;
+}
+
+/*
+ * Creates a layout from the FMAP found in an image buffer.
+ *
+ * Returns 0 on success, 2 if no FMAP was found and 1 on any other error.
+ */
+int layout_from_fmap_buffer(struct flashrom_layout **const layout, const uint8_t *const buf, const size_t len,
+			    const chipsize_t chip_size)
+{
+	size_t offset;
+
+	if (fmap_find_in_buffer(buf, len, &offset)) {
+		msg_gerr("No FMAP found in image.\n");
+		return 2;
+	}
+	msg_gdbg("FMAP found at offset 0x%06zx.\n", offset);
+
+	return fmap_to_layout(layout, buf + offset, chip_size);
+}
+
+/* Reads the FMAP header and areas at `offset`. Returns NULL if there is no valid FMAP. */
+static uint8_t *fmap_read_at(struct flashctx *const flashctx, const chipoff_t offset)
+{
+	const chipsize_t chip_size = flashctx->chip->total_size * 1024;
+	uint8_t hdr[FMAP_HEADER_LEN];
+
+	if (offset + FMAP_HEADER_LEN > chip_size)
+		return NULL;
+	if (flashctx->chip->read(flashctx, hdr, offset, sizeof(hdr)))
+		return NULL;
+	const unsigned int nareas = fmap_check_header(hdr);
+	if (!nareas)
+		return NULL;
+
+	const size_t fmap_len = FMAP_HEADER_LEN + nareas * FMAP_AREA_LEN;
+	if (offset + fmap_len > chip_size)
+		return NULL;
+	uint8_t *const fmap = malloc(fmap_len);
+	if (!fmap) {
+		msg_gerr("Out of memory!\n");
+		return NULL;
+	}
+	memcpy(fmap, hdr, sizeof(hdr));
+	if (flashctx->chip->read(flashctx, fmap + sizeof(hdr), offset + sizeof(hdr), fmap_len - sizeof(hdr))) {
+		free(fmap);
+		return NULL;
+	}
+	return fmap;
+}
+
+/*
+ * Searches the flash chip for the FMAP in large chunks. Each chunk is scanned
+ * with memchr() like in fmap_find_in_buffer(), the last bytes of the previous
+ * chunk are kept to find headers that cross the chunk boundary.
+ *
+ * Returns 0 and sets `*fmap` like fmap_read_at() and `*offset` if an FMAP was
+ * found, 2 if there is none and 1 on any other error.
+ */
+static int fmap_search_flash(struct flashctx *const flashctx, uint8_t **const fmap, chipoff_t *const offset)
+{
+	const chipsize_t chip_size = flashctx->chip->total_size * 1024;
+	uint8_t *const buf = malloc(FMAP_HEADER_LEN - 1 + FMAP_SEARCH_CHUNK);
+	chipoff_t start;
+	size_t keep = 0;
+	int ret = 2;
+
+	if (!buf) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+
+	for (start = 0; start < chip_size && ret == 2; start += FMAP_SEARCH_CHUNK) {
+		const size_t len = min(FMAP_SEARCH_CHUNK, chip_size - start);
+		if (flashctx->chip->read(flashctx, buf + keep, start, len)) {
+			msg_cerr("Read operation failed!\n");
+			ret = 1;
+			break;
+		}
+
+		/* `buf` starts `keep` bytes before `start`. */
+		const size_t avail = keep + len;
+		const uint8_t *p = buf;
+		while (avail >= FMAP_HEADER_LEN && p <= buf + avail - FMAP_HEADER_LEN) {
+			p = memchr(p, FMAP_SIGNATURE[0], buf + avail - FMAP_HEADER_LEN - p + 1);
+			if (!p)
+				break;
+			if (fmap_check_header(p)) {
+				*offset = start - keep + (p - buf);
+				*fmap = fmap_read_at(flashctx, *offset);
+				if (*fmap) {
+					ret = 0;
+					break;
+				}
+			}
+			++p;
+		}
+
+		keep = min(FMAP_HEADER_LEN - 1, avail);
+		memmove(buf, buf + avail - keep, keep);
+	}
+	free(buf);
+	return ret;
+}
+
+/*
+ * Creates a layout from the FMAP stored on the flash chip.
+ *
+ * The FMAP is usually aligned to a large power of two, so we probe the
+ * signature at aligned offsets from the largest alignment down, each
+ * offset only once. That reads a few bytes per probe instead of the whole
+ * chip. The number of probes is bounded, since many small reads are slow
+ * on high-latency programmers. If probing fails, the chip is searched in
+ * large chunks until the FMAP is found.
+ *
+ * The flash has to be prepared for reading by the caller.
+ *
+ * Returns 0 on success, 2 if no FMAP was found and 1 on any other error.
+ */
+int layout_from_fmap_flash(struct flashrom_layout **const layout, struct flashctx *const flashctx)
+{
+	const chipsize_t chip_size = flashctx->chip->total_size * 1024;
+	unsigned int probes = 0;
+	uint8_t *fmap = NULL;
+	chipoff_t stride, offset;
+	int ret;
+
+	msg_cinfo("Searching for FMAP... ");
+	for (stride = chip_size; stride >= FMAP_MIN_STRIDE && !fmap && probes < FMAP_MAX_PROBES; stride /= 2) {
+		/* Offsets aligned to 2 * stride were already checked in the previous round. */
+		for (offset = (stride == chip_size) ? 0 : stride; offset < chip_size; offset += 2 * stride) {
+			if (probes++ == FMAP_MAX_PROBES)
+				break;
+			fmap = fmap_read_at(flashctx, offset);
+			if (fmap)
+				break;
+		}
+	}
+
+	if (!fmap) {
+		msg_cdbg("not at a probed offset, searching the whole chip. ");
+		ret = fmap_search_flash(flashctx, &fmap, &offset);
+		if (ret == 2)
+			msg_cerr("No FMAP found on the flash chip.\n");
+		if (ret) {
+			msg_cinfo("FAILED.\n");
+			return ret;
+		}
+	}
+
+	msg_cdbg("found at offset 0x%06x. ", offset);
+	ret = fmap_to_layout(layout, fmap, chip_size);
+	free(fmap);
+	msg_cinfo("%s.\n", ret ? "FAILED" : "done");
+	return ret;
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#ifndef __FMAP_H__
+#define __FMAP_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include "layout.h"
+
+/*
+ * On-flash format of the flashmap (FMAP) as used by coreboot and ChromeOS.
+ * All multi-byte fields are little endian and the structures are packed,
+ * so they are decoded byte-wise instead of being overlaid on the image.
+ */
+#define FMAP_SIGNATURE		"__FMAP__"
+#define FMAP_SIGNATURE_LEN	8
+#define FMAP_VER_MAJOR		1
+#define FMAP_STRLEN		32
+
+/* signature, ver_major, ver_minor, base, size, name, nareas */
+#define FMAP_HEADER_LEN		(FMAP_SIGNATURE_LEN + 1 + 1 + 8 + 4 + FMAP_STRLEN + 2)
+/* offset, size, name, flags */
+#define FMAP_AREA_LEN		(4 + 4 + FMAP_STRLEN + 2)
+
+#define FMAP_AREA_STATIC	(1 << 0)
+#define FMAP_AREA_COMPRESSED	(1 << 1)
+#define FMAP_AREA_RO		(1 << 2)
+#define FMAP_AREA_PRESERVE	(1 << 3)
+
+/* A layout whose entries are allocated along with it, one per FMAP area. */
+struct fmap_layout {
+	struct flashrom_layout base;
+	struct romentry entries[];
+};
+
+struct flashrom_flashctx;
+int fmap_find_in_buffer(const uint8_t *buf, size_t len, size_t *offset);
+int layout_from_fmap_buffer(struct flashrom_layout **layout, const uint8_t *buf, size_t len, chipsize_t chip_size);
+int layout_from_fmap_flash(struct flashrom_layout **layout, struct flashrom_flashctx *flashctx);
+
+#endif				/* !__FMAP_H__ */
@@ -53,6 +53,19 @@ int min(int a, int b)
 	return (a < b) ? a : b;
 }
 
+/* 64-bit FNV-1a. Not meant to resist tampering, only to detect changes. */
+uint64_t fnv1a_64(const uint8_t *buf, size_t len)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	size_t i;
+
+	for (i = 0; i < len; ++i) {
+		hash ^= buf[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
 char *strcat_realloc(char *dest, const char *src)
 {
 	dest = realloc(dest, strlen(dest) + strlen(src) + 1);
@@ -123,6 +123,108 @@ int register_superio(struct superio s)
 	return 0;
 }
 
+/*
+ * Super I/O probing uses slow config-mode sequences on several ports and
+ * may even irritate other chips on the LPC bus. On systems that have no
+ * Super I/O at all, its result can be remembered in a cache file, keyed
+ * by a fingerprint of the DMI strings and all PCI device IDs. Checking
+ * the fingerprint only needs data that we have already read anyway.
+ */
+#define SUPERIO_CACHE_HEADER "flashrom superio cache v1"
+
+static uint64_t superio_cache_fingerprint(void)
+{
+	uint64_t hash = dmi_fingerprint();
+	struct pci_dev *dev;
+
+	for (dev = pacc->devices; dev; dev = dev->next) {
+		const uint8_t ids[] = {
+			dev->bus, dev->dev, dev->func,
+			dev->vendor_id & 0xff, dev->vendor_id >> 8,
+			dev->device_id & 0xff, dev->device_id >> 8,
+		};
+		hash = hash * 31 + fnv1a_64(ids, sizeof(ids));
+	}
+	return hash;
+}
+
+/* Returns 1 if the cache is valid for this system, and sets `*count` to the number of cached Super I/Os. */
+static int superio_cache_load(const char *const filename, const uint64_t fingerprint, int *const count)
+{
+#ifndef __LIBPAYLOAD__
+	char header[64];
+	unsigned long long cached;
+	int ret = 0;
+
+	FILE *const cache = fopen(filename, "r");
+	if (!cache) {
+		msg_pdbg("No Super I/O cache at %s yet.\n", filename);
+		return 0;
+	}
+	if (fgets(header, sizeof(header), cache) && !strncmp(header, SUPERIO_CACHE_HEADER,
+							      strlen(SUPERIO_CACHE_HEADER)) &&
+	    fscanf(cache, "fingerprint %llx superios %d", &cached, count) == 2) {
+		if (cached == fingerprint)
+			ret = 1;
+		else
+			msg_pdbg("Super I/O cache at %s is for different hardware.\n", filename);
+	} else {
+		msg_pwarn("Ignoring malformed Super I/O cache at %s.\n", filename);
+	}
+	(void)fclose(cache);
+	return ret;
+#else
+	return 0;
+#endif
+}
+
+static void superio_cache_store(const char *const filename, const uint64_t fingerprint)
+{
+#ifndef __LIBPAYLOAD__
+	int i;
+
+	FILE *const cache = fopen(filename, "w");
+	if (!cache) {
+		msg_pwarn("Can't write Super I/O cache to %s.\n", filename);
+		return;
+	}
+	fprintf(cache, SUPERIO_CACHE_HEADER "\nfingerprint %016llx\nsuperios %d\n",
+		(unsigned long long)fingerprint, superio_count);
+	/* Only informational, Super I/Os are always probed if there is any. */
+	for (i = 0; i < superio_count; i++)
+		fprintf(cache, "vendor %d port 0x%x model 0x%04x\n",
+			superios[i].vendor, superios[i].port, superios[i].model);
+	if (fclose(cache))
+		msg_pwarn("Can't write Super I/O cache to %s.\n", filename);
+#endif
+}
+
+/* Probes for Super I/O chips unless the cache says there are none. */
+static void probe_superio_cached(const char *const cache)
+{
+	int cached_count = 0;
+
+	if (!cache) {
+		probe_superio();
+		return;
+	}
+
+	const uint64_t fingerprint = superio_cache_fingerprint();
+	if (superio_cache_load(cache, fingerprint, &cached_count)) {
+		if (!cached_count) {
+			msg_pdbg("Super I/O cache says there is none, skipping probe.\n");
+			return;
+		}
+		probe_superio();
+		if (superio_count == cached_count)
+			return;
+		msg_pdbg("Super I/O detection differs from the cache, updating it.\n");
+	} else {
+		probe_superio();
+	}
+	superio_cache_store(cache, fingerprint);
+}
+
 #endif
 
 int is_laptop = 0;
@@ -167,6 +269,7 @@ int internal_init(void)
 	const char *cb_model = NULL;
 #endif
 	char *arg;
+	char *superio_cache = NULL;
 
 	arg = extract_programmer_param("boardenable");
 	if (arg && !strcmp(arg,"force")) {
@@ -225,8 +328,20 @@ int internal_init(void)
 	}
 	free(arg);
 
-	if (rget_io_perms())
+#if IS_X86
+	arg = extract_programmer_param("superio_cache");
+	if (arg && !strlen(arg)) {
+		msg_perr("Missing argument for superio_cache.\n");
+		free(arg);
 		return 1;
+	}
+	superio_cache = arg;
+#endif
+
+	if (rget_io_perms()) {
+		free(superio_cache);
+		return 1;
+	}
 
 	/* Default to Parallel/LPC/FWH flash devices. If a known host controller
 	 * is found, the host controller init routine sets the
@@ -235,12 +350,15 @@ int internal_init(void)
 	internal_buses_supported = BUS_NONSPI;
 
 	/* Initialize PCI access for flash enables */
-	if (pci_init_common() != 0)
+	if (pci_init_common() != 0) {
+		free(superio_cache);
 		return 1;
+	}
 
 	if (processor_flash_enable()) {
 		msg_perr("Processor detection/init failed.\n"
 			 "Aborting.\n");
+		free(superio_cache);
 		return 1;
 	}
 
@@ -250,8 +368,10 @@ int internal_init(void)
 			msg_pwarn("Warning: The mainboard IDs set by -p internal:mainboard (%s:%s) do not\n"
 				  "         match the current coreboot IDs of the mainboard (%s:%s).\n",
 				  board_vendor, board_model, cb_vendor, cb_model);
-			if (!force_boardmismatch)
+			if (!force_boardmismatch) {
+				free(superio_cache);
 				return 1;
+			}
 			msg_pinfo("Continuing anyway.\n");
 		}
 	}
@@ -264,7 +384,8 @@ int internal_init(void)
 	board_handle_before_superio();
 
 	/* Probe for the Super I/O chip and fill global struct superio. */
-	probe_superio();
+	probe_superio_cached(superio_cache);
+	free(superio_cache);
 #else
 	/* FIXME: Enable cbtable searching on all non-x86 platforms supported
 	 *        by coreboot.
@@ -79,6 +79,12 @@
 
 #ifdef LPC_IO
 unsigned int shm_io_base;
+/* Last value written to INDIRECT_A1, -1 if unknown. */
+static int shm_io_a1 = -1;
+/* Mapping of ce_low to read data through, NULL if it's not mapped. */
+static const void *ce_low_window;
+/* ce_low_window was compared against reads through the indirect access. */
+static bool ce_low_window_checked;
 #endif
 unsigned char *ce_high, *ce_low;
 static int it85xx_scratch_rom_reenter = 0;
@@ -114,9 +120,10 @@ void it85xx_enter_scratch_rom(void)
 {
 	int ret, tries;
 
-	msg_pdbg("%s():%d was called ...\n", __func__, __LINE__);
+	/* This is called for every SPI command, so don't be chatty. */
 	if (it85xx_scratch_rom_reenter > 0)
 		return;
+	msg_pdbg("%s():%d was called ...\n", __func__, __LINE__);
 
 #if 0
 	/* FIXME: this a workaround for the bug that SMBus signal would
@@ -256,6 +263,18 @@ static int it85xx_spi_common_init(struct superio s)
 	INDIRECT_A0(shm_io_base, base & 0xFF);
 	INDIRECT_A2(shm_io_base, (base >> 16) & 0xFF);
 	INDIRECT_A3(shm_io_base, (base >> 24));
+	shm_io_a1 = -1;
+
+	/* Data may be read through the memory window (follow mode) instead of
+	 * INDIRECT_READ, if the window turns out to reach the EC. Everything
+	 * else still goes through the indirect access. */
+	ce_low_window = NULL;
+	ce_low_window_checked = false;
+	const void *const window = rphysmap("it85 communication", 0xFFFFF000, 0x1000);
+	if (window != ERROR_PTR)
+		ce_low_window = (const uint8_t *)window + 0xD00;  /* 0xFFFFFD00 */
+	else
+		msg_pdbg("%s():%d memory window unavailable, reading through I/O\n", __func__, __LINE__);
 #endif
 #ifdef LPC_MEMORY
 	/* FIXME: We should block accessing that region for anything else.
@@ -278,13 +297,16 @@ static int it85xx_spi_send_command(struct flashctx *flash,
 				   unsigned int writecnt, unsigned int readcnt,
 				   const unsigned char *writearr,
 				   unsigned char *readarr);
+static int it85xx_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds);
 
+/* The EC shifts every byte out as it's accessed and doesn't buffer anything,
+ * so a transfer can be as long as we like. */
 static const struct spi_master spi_master_it85xx = {
 	.type		= SPI_CONTROLLER_IT85XX,
-	.max_data_read	= 64,
-	.max_data_write	= 64,
+	.max_data_read	= MAX_DATA_READ_UNLIMITED,
+	.max_data_write	= MAX_DATA_WRITE_UNLIMITED,
 	.command	= it85xx_spi_send_command,
-	.multicommand	= default_spi_send_multicommand,
+	.multicommand	= it85xx_spi_send_multicommand,
 	.read		= default_spi_read,
 	.write_256	= default_spi_write_256,
 	.write_aai	= default_spi_write_aai,
@@ -327,49 +349,117 @@ int it85xx_spi_init(struct superio s)
  *   3. read date from LPC/FWH address 0xffff_fdxxh (drive CE# low and get
  *      data from MISO)
  */
-static int it85xx_spi_send_command(struct flashctx *flash,
-				   unsigned int writecnt, unsigned int readcnt,
-				   const unsigned char *writearr,
-				   unsigned char *readarr)
+#ifdef LPC_IO
+/* Points the indirect access at the page of addr, unless it's there already. */
+static void it85xx_select_page(const unsigned char *addr)
 {
-	int i;
+	const int a1 = (((unsigned long int)addr) >> 8) & 0xff;
 
-	it85xx_enter_scratch_rom();
-	/* Exit scratch ROM ONLY when programmer shuts down. Otherwise, the
-	 * temporary flash state may halt the EC.
-	 */
+	if (a1 == shm_io_a1)
+		return;
+	INDIRECT_A1(shm_io_base, a1);
+	shm_io_a1 = a1;
+}
+#endif
 
+static void it85xx_drive_ce_high(void)
+{
 #ifdef LPC_IO
-	INDIRECT_A1(shm_io_base, (((unsigned long int)ce_high) >> 8) & 0xff);
+	it85xx_select_page(ce_high);
 	INDIRECT_WRITE(shm_io_base, 0xFF);  /* Write anything to this address.*/
-	INDIRECT_A1(shm_io_base, (((unsigned long int)ce_low) >> 8) & 0xff);
 #endif
 #ifdef LPC_MEMORY
 	mmio_writeb(0, ce_high);
 #endif
-	for (i = 0; i < writecnt; ++i) {
+}
+
+/* Runs one SPI command with CE# low, CE# has to be high before. */
+static void it85xx_spi_transfer(unsigned int writecnt, unsigned int readcnt,
+				const unsigned char *writearr, unsigned char *readarr)
+{
+	unsigned int i;
+
 #ifdef LPC_IO
+	it85xx_select_page(ce_low);
+	for (i = 0; i < writecnt; ++i)
 		INDIRECT_WRITE(shm_io_base, writearr[i]);
-#endif
-#ifdef LPC_MEMORY
-		mmio_writeb(writearr[i], ce_low);
-#endif
+	if (ce_low_window) {
+		for (i = 0; i < readcnt; ++i)
+			readarr[i] = mmio_readb(ce_low_window);
+	} else {
+		for (i = 0; i < readcnt; ++i)
+			readarr[i] = INDIRECT_READ(shm_io_base);
 	}
-	for (i = 0; i < readcnt; ++i) {
-#ifdef LPC_IO
-		readarr[i] = INDIRECT_READ(shm_io_base);
 #endif
 #ifdef LPC_MEMORY
+	for (i = 0; i < writecnt; ++i)
+		mmio_writeb(writearr[i], ce_low);
+	for (i = 0; i < readcnt; ++i)
 		readarr[i] = mmio_readb(ce_low);
 #endif
-	}
+	it85xx_drive_ce_high();
+}
+
+/* Nothing guarantees that the LPC/FWH cycles to 0xFFFFFD00 reach the EC, so
+ * before reading through the window, compare an RDID read through it with
+ * one through INDIRECT_READ. Reads stay indirect unless both return the same
+ * ID that isn't all 0x00 or all 0xff. CE# has to be high before. */
+static void it85xx_check_window(void)
+{
 #ifdef LPC_IO
-	INDIRECT_A1(shm_io_base, (((unsigned long int)ce_high) >> 8) & 0xff);
-	INDIRECT_WRITE(shm_io_base, 0xFF);  /* Write anything to this address.*/
-#endif
-#ifdef LPC_MEMORY
-	mmio_writeb(0, ce_high);
+	const unsigned char cmd = JEDEC_RDID;
+	unsigned char indirect[JEDEC_RDID_INSIZE], window[JEDEC_RDID_INSIZE];
+	const void *const mapped = ce_low_window;
+
+	if (ce_low_window_checked)
+		return;
+	ce_low_window_checked = true;
+	if (!mapped)
+		return;
+
+	ce_low_window = NULL;
+	it85xx_spi_transfer(sizeof(cmd), sizeof(indirect), &cmd, indirect);
+	ce_low_window = mapped;
+	it85xx_spi_transfer(sizeof(cmd), sizeof(window), &cmd, window);
+
+	if (memcmp(indirect, window, sizeof(window)) ||
+	    (indirect[0] == 0x00 && indirect[1] == 0x00 && indirect[2] == 0x00) ||
+	    (indirect[0] == 0xff && indirect[1] == 0xff && indirect[2] == 0xff)) {
+		msg_pdbg("%s():%d memory window doesn't reach the EC, reading through I/O\n",
+			 __func__, __LINE__);
+		ce_low_window = NULL;
+	} else {
+		msg_pdbg("%s():%d reading through the memory window\n", __func__, __LINE__);
+	}
 #endif
+}
+
+static int it85xx_spi_send_command(struct flashctx *flash,
+				   unsigned int writecnt, unsigned int readcnt,
+				   const unsigned char *writearr,
+				   unsigned char *readarr)
+{
+	it85xx_enter_scratch_rom();
+	/* Exit scratch ROM ONLY when programmer shuts down. Otherwise, the
+	 * temporary flash state may halt the EC.
+	 */
+
+	it85xx_drive_ce_high();
+	it85xx_check_window();
+	it85xx_spi_transfer(writecnt, readcnt, writearr, readarr);
+
+	return 0;
+}
+
+/* Every command ends with CE# high, so the next one can start right away. */
+static int it85xx_spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds)
+{
+	it85xx_enter_scratch_rom();
+
+	it85xx_drive_ce_high();
+	it85xx_check_window();
+	for (; cmds->writecnt || cmds->readcnt; ++cmds)
+		it85xx_spi_transfer(cmds->writecnt, cmds->readcnt, cmds->writearr, cmds->readarr);
 
 	return 0;
 }
@@ -123,6 +123,31 @@ static void start_program_jedec_common(const struct flashctx *flash, unsigned in
 	chip_writeb(flash, 0xA0, bios + ((shifted ? 0x2AAA : 0x5555) & mask));
 }
 
+/*
+ * Unlock bypass mode of AMD and compatible chips: after entering it once,
+ * a byte program only takes the 0xA0 command and the data, i.e. two bus
+ * cycles instead of four. Other commands than program and exit are ignored
+ * until the mode is left again.
+ */
+static void enter_unlock_bypass_jedec_common(const struct flashctx *flash, unsigned int mask)
+{
+	chipaddr bios = flash->virtual_memory;
+	bool shifted = (flash->chip->feature_bits & FEATURE_ADDR_SHIFTED);
+
+	chip_writeb(flash, 0xAA, bios + ((shifted ? 0x2AAA : 0x5555) & mask));
+	chip_writeb(flash, 0x55, bios + ((shifted ? 0x5555 : 0x2AAA) & mask));
+	chip_writeb(flash, 0x20, bios + ((shifted ? 0x2AAA : 0x5555) & mask));
+}
+
+static void exit_unlock_bypass_jedec_common(const struct flashctx *flash)
+{
+	chipaddr bios = flash->virtual_memory;
+
+	/* The address of both cycles is don't care. */
+	chip_writeb(flash, 0x90, bios);
+	chip_writeb(flash, 0x00, bios);
+}
+
 int probe_jedec_29gl(struct flashctx *flash)
 {
 	unsigned int mask = getaddrmask(flash->chip);
@@ -392,7 +417,10 @@ static int write_byte_program_jedec_common(const struct flashctx *flash, const u
 
 retry:
 	/* Issue JEDEC Byte Program command */
-	start_program_jedec_common(flash, mask);
+	if (flash->chip->feature_bits & FEATURE_UNLOCK_BYPASS)
+		chip_writeb(flash, 0xA0, bios);
+	else
+		start_program_jedec_common(flash, mask);
 
 	/* transfer data from source to destination */
 	chip_writeb(flash, *src, dst);
@@ -419,12 +447,18 @@ int write_jedec_1(struct flashctx *flash, const uint8_t *src, unsigned int start
 
 	mask = getaddrmask(flash->chip);
 
+	if (flash->chip->feature_bits & FEATURE_UNLOCK_BYPASS)
+		enter_unlock_bypass_jedec_common(flash, mask);
+
 	olddst = dst;
 	for (i = 0; i < len; i++) {
 		if (write_byte_program_jedec_common(flash, src, dst, mask))
 			failed = 1;
 		dst++, src++;
 	}
+
+	if (flash->chip->feature_bits & FEATURE_UNLOCK_BYPASS)
+		exit_unlock_bypass_jedec_common(flash);
 	if (failed)
 		msg_cerr(" writing sector at 0x%" PRIxPTR " failed!\n", olddst);
 
@@ -567,14 +601,49 @@ struct unlockblock {
 	unsigned int count;
 };
 
-typedef int (*unlockblock_func)(const struct flashctx *flash, chipaddr offset);
-static int regspace2_walk_unlockblocks(const struct flashctx *flash, const struct unlockblock *block, unlockblock_func func)
+#define REG2_RWLOCK ((1 << 2) | (1 << 0))
+#define REG2_LOCKDOWN (1 << 1)
+#define REG2_MASK (REG2_RWLOCK | REG2_LOCKDOWN)
+
+/*
+ * Returns the lock registers of all blocks in the order of `block`. They are read
+ * once per flash access and changelock_regspace2_block() keeps them up to date, so
+ * all lock functions of a chip have to use the same blocks.
+ */
+static uint8_t *regspace2_locks(struct flashctx *flash, const struct unlockblock *block)
 {
 	chipaddr off = flash->virtual_registers + 2;
+	unsigned int i = 0;
+
+	if (flash->locks_valid)
+		return flash->locks;
+
+	for (; block->count != 0; block++) {
+		unsigned int j;
+		for (j = 0; j < block->count; j++, i++, off += block->size) {
+			if (i == MAX_LOCK_BLOCKS) {
+				msg_cerr("More than %d lock blocks!\n"
+					 "Please report a bug at flashrom@flashrom.org\n", MAX_LOCK_BLOCKS);
+				return NULL;
+			}
+			flash->locks[i] = chip_readb(flash, off);
+		}
+	}
+	flash->locks_valid = true;
+	return flash->locks;
+}
+
+typedef int (*unlockblock_func)(struct flashctx *flash, chipaddr offset, uint8_t *state);
+static int regspace2_walk_unlockblocks(struct flashctx *flash, const struct unlockblock *block, unlockblock_func func)
+{
+	uint8_t *state = regspace2_locks(flash, block);
+	chipaddr off = flash->virtual_registers + 2;
+	if (!state)
+		return -1;
 	while (block->count != 0) {
 		unsigned int j;
 		for (j = 0; j < block->count; j++) {
-			if (func(flash, off))
+			if (func(flash, off, state++))
 				return -1;
 			off += block->size;
 		}
@@ -583,15 +652,10 @@ static int regspace2_walk_unlockblocks(const struct flashctx *flash, const struc
 	return 0;
 }
 
-#define REG2_RWLOCK ((1 << 2) | (1 << 0))
-#define REG2_LOCKDOWN (1 << 1)
-#define REG2_MASK (REG2_RWLOCK | REG2_LOCKDOWN)
-
-static int printlock_regspace2_block(const struct flashctx *flash, chipaddr lockreg)
+static int printlock_regspace2_block(struct flashctx *flash, chipaddr lockreg, uint8_t *state)
 {
-	uint8_t state = chip_readb(flash, lockreg);
 	msg_cdbg("Lock status of block at 0x%0*" PRIxPTR " is ", PRIxPTR_WIDTH, lockreg);
-	switch (state & REG2_MASK) {
+	switch (*state & REG2_MASK) {
 	case 0:
 		msg_cdbg("Full Access.\n");
 		break;
@@ -620,7 +684,7 @@ static int printlock_regspace2_block(const struct flashctx *flash, chipaddr lock
 	return 0;
 }
 
-int printlock_regspace2_blocks(const struct flashctx *flash, const struct unlockblock *blocks)
+int printlock_regspace2_blocks(struct flashctx *flash, const struct unlockblock *blocks)
 {
 	return regspace2_walk_unlockblocks(flash, blocks, &printlock_regspace2_block);
 }
@@ -653,14 +717,16 @@ int printlock_regspace2_block_eraser_1(struct flashctx *flash)
 	return regspace2_walk_unlockblocks(flash, unlockblocks, &printlock_regspace2_block);
 }
 
-/* Try to change the lock register at address lockreg from cur to new.
+/* Try to change the lock register at address lockreg from its cached value in state to new.
  *
  * - Try to unlock the lock bit if requested and it is currently set (although this is probably futile).
  * - Try to change the read/write bits if requested.
  * - Try to set the lockdown bit if requested.
- * Return an error immediately if any of this fails. */
-static int changelock_regspace2_block(const struct flashctx *flash, chipaddr lockreg, uint8_t cur, uint8_t new)
+ * Return an error immediately if any of this fails. The cached value is updated on the way. */
+static int changelock_regspace2_block(const struct flashctx *flash, chipaddr lockreg, uint8_t *state, uint8_t new)
 {
+	uint8_t cur = *state;
+
 	/* Only allow changes to known read/write/lockdown bits */
 	if (((cur ^ new) & ~REG2_MASK) != 0) {
 		msg_cerr("Invalid lock change from 0x%02x to 0x%02x requested at 0x%0*" PRIxPTR "!\n"
@@ -678,7 +744,7 @@ static int changelock_regspace2_block(const struct flashctx *flash, chipaddr loc
 	/* Normally the lockdown bit can not be cleared. Try nevertheless if requested. */
 	if ((cur & REG2_LOCKDOWN) && !(new & REG2_LOCKDOWN)) {
 		chip_writeb(flash, cur & ~REG2_LOCKDOWN, lockreg);
-		cur = chip_readb(flash, lockreg);
+		cur = *state = chip_readb(flash, lockreg);
 		if ((cur & REG2_LOCKDOWN) == REG2_LOCKDOWN) {
 			msg_cwarn("Lockdown can't be removed at 0x%0*" PRIxPTR "! New value: 0x%02x.\n",
 				  PRIxPTR_WIDTH, lockreg, cur);
@@ -691,7 +757,7 @@ static int changelock_regspace2_block(const struct flashctx *flash, chipaddr loc
 		/* Do not lockdown yet. */
 		uint8_t wanted = (cur & ~REG2_RWLOCK) | (new & REG2_RWLOCK);
 		chip_writeb(flash, wanted, lockreg);
-		cur = chip_readb(flash, lockreg);
+		cur = *state = chip_readb(flash, lockreg);
 		if (cur != wanted) {
 			msg_cerr("Changing lock bits failed at 0x%0*" PRIxPTR "! New value: 0x%02x.\n",
 				 PRIxPTR_WIDTH, lockreg, cur);
@@ -704,7 +770,7 @@ static int changelock_regspace2_block(const struct flashctx *flash, chipaddr loc
 	/* Eventually, enable lockdown if requested. */
 	if (!(cur & REG2_LOCKDOWN) && (new & REG2_LOCKDOWN)) {
 		chip_writeb(flash, new, lockreg);
-		cur = chip_readb(flash, lockreg);
+		cur = *state = chip_readb(flash, lockreg);
 		if (cur != new) {
 			msg_cerr("Enabling lockdown FAILED at 0x%0*" PRIxPTR "! New value: 0x%02x.\n",
 				 PRIxPTR_WIDTH, lockreg, cur);
@@ -716,11 +782,11 @@ static int changelock_regspace2_block(const struct flashctx *flash, chipaddr loc
 	return 0;
 }
 
-static int unlock_regspace2_block_generic(const struct flashctx *flash, chipaddr lockreg)
+static int unlock_regspace2_block_generic(struct flashctx *flash, chipaddr lockreg, uint8_t *state)
 {
-	uint8_t old = chip_readb(flash, lockreg);
-	/* We don't care for the lockdown bit as long as the RW locks are 0 after we're done */
-	return changelock_regspace2_block(flash, lockreg, old, old & ~REG2_RWLOCK);
+	/* We don't care for the lockdown bit as long as the RW locks are 0 after we're done.
+	   Blocks that are unlocked already aren't touched at all. */
+	return changelock_regspace2_block(flash, lockreg, state, *state & ~REG2_RWLOCK);
 }
 
 static int unlock_regspace2_uniform(struct flashctx *flash, unsigned long block_size)
@@ -756,3 +822,99 @@ int unlock_regspace2_block_eraser_1(struct flashctx *flash)
 	return regspace2_walk_unlockblocks(flash, unlockblocks, &unlock_regspace2_block_generic);
 }
 
+/* Each lock register covers the block it is named after, see regspace2_walk_unlockblocks(). */
+static int protection_regspace2_blocks(struct flashctx *flash, const struct unlockblock *block,
+				       struct protection *prot)
+{
+	const uint8_t *locks = regspace2_locks(flash, block);
+	chipoff_t start = 0;
+
+	prot->count = 0;
+	if (!locks)
+		return 1;
+	for (; block->count != 0; block++) {
+		unsigned int j;
+		for (j = 0; j < block->count; j++, start += block->size) {
+			const uint8_t state = *locks++;
+			if (!(state & REG2_RWLOCK))
+				continue;
+			/* Locked down blocks keep their locks until the next reset. */
+			if (protection_add(prot, start, block->size, state & (1 << 2), state & REG2_LOCKDOWN))
+				return 1;
+		}
+	}
+	return 0;
+}
+
+/* Unlocks the blocks overlapping [start, start + len) only. */
+static int unprotect_regspace2_blocks(struct flashctx *flash, const struct unlockblock *block,
+				      chipoff_t start, chipsize_t len)
+{
+	uint8_t *locks = regspace2_locks(flash, block);
+	chipoff_t off = 0;
+
+	if (!locks)
+		return 1;
+	for (; block->count != 0; block++) {
+		unsigned int j;
+		for (j = 0; j < block->count; j++, off += block->size, locks++) {
+			if (off + block->size <= start || off >= start + len)
+				continue;
+			if (unlock_regspace2_block_generic(flash, flash->virtual_registers + 2 + off, locks))
+				return 1;
+		}
+	}
+	return 0;
+}
+
+int protection_regspace2_uniform_64k(struct flashctx *flash, struct protection *prot)
+{
+	const struct unlockblock blocks[2] = {{.size = 64 * 1024, .count = flash->chip->total_size / 64}};
+	return protection_regspace2_blocks(flash, blocks, prot);
+}
+
+int protection_regspace2_uniform_32k(struct flashctx *flash, struct protection *prot)
+{
+	const struct unlockblock blocks[2] = {{.size = 32 * 1024, .count = flash->chip->total_size / 32}};
+	return protection_regspace2_blocks(flash, blocks, prot);
+}
+
+int protection_regspace2_block_eraser_0(struct flashctx *flash, struct protection *prot)
+{
+	// FIXME: this depends on the eraseblocks not to be filled up completely (i.e. to be null-terminated).
+	return protection_regspace2_blocks(flash,
+		(const struct unlockblock *)flash->chip->block_erasers[0].eraseblocks, prot);
+}
+
+int protection_regspace2_block_eraser_1(struct flashctx *flash, struct protection *prot)
+{
+	// FIXME: this depends on the eraseblocks not to be filled up completely (i.e. to be null-terminated).
+	return protection_regspace2_blocks(flash,
+		(const struct unlockblock *)flash->chip->block_erasers[1].eraseblocks, prot);
+}
+
+int unprotect_regspace2_uniform_64k(struct flashctx *flash, chipoff_t start, chipsize_t len)
+{
+	const struct unlockblock blocks[2] = {{.size = 64 * 1024, .count = flash->chip->total_size / 64}};
+	return unprotect_regspace2_blocks(flash, blocks, start, len);
+}
+
+int unprotect_regspace2_uniform_32k(struct flashctx *flash, chipoff_t start, chipsize_t len)
+{
+	const struct unlockblock blocks[2] = {{.size = 32 * 1024, .count = flash->chip->total_size / 32}};
+	return unprotect_regspace2_blocks(flash, blocks, start, len);
+}
+
+int unprotect_regspace2_block_eraser_0(struct flashctx *flash, chipoff_t start, chipsize_t len)
+{
+	// FIXME: this depends on the eraseblocks not to be filled up completely (i.e. to be null-terminated).
+	return unprotect_regspace2_blocks(flash,
+		(const struct unlockblock *)flash->chip->block_erasers[0].eraseblocks, start, len);
+}
+
+int unprotect_regspace2_block_eraser_1(struct flashctx *flash, chipoff_t start, chipsize_t len)
+{
+	// FIXME: this depends on the eraseblocks not to be filled up completely (i.e. to be null-terminated).
+	return unprotect_regspace2_blocks(flash,
+		(const struct unlockblock *)flash->chip->block_erasers[1].eraseblocks, start, len);
+}
@@ -33,6 +33,7 @@
 #include "layout.h"
 #include "hwaccess.h"
 #include "ich_descriptors.h"
+#include "fmap.h"
 #include "libflashrom.h"
 
 /**
@@ -237,6 +238,7 @@ size_t flashrom_flash_getsize(const struct flashrom_flashctx *const flashctx)
  */
 void flashrom_flash_release(struct flashrom_flashctx *const flashctx)
 {
+	flashrom_session_end(flashctx);
 	free(flashctx);
 }
 
@@ -255,6 +257,8 @@ void flashrom_flag_set(struct flashrom_flashctx *const flashctx,
 		case FLASHROM_FLAG_FORCE_BOARDMISMATCH:	flashctx->flags.force_boardmismatch = value; break;
 		case FLASHROM_FLAG_VERIFY_AFTER_WRITE:	flashctx->flags.verify_after_write = value; break;
 		case FLASHROM_FLAG_VERIFY_WHOLE_CHIP:	flashctx->flags.verify_whole_chip = value; break;
+		case FLASHROM_FLAG_CONSISTENT_READ:	flashctx->flags.consistent_read = value; break;
+		case FLASHROM_FLAG_ERASE_SUSPEND:	flashctx->flags.erase_suspend = value; break;
 	}
 }
 
@@ -272,6 +276,8 @@ bool flashrom_flag_get(const struct flashrom_flashctx *const flashctx, const enu
 		case FLASHROM_FLAG_FORCE_BOARDMISMATCH:	return flashctx->flags.force_boardmismatch;
 		case FLASHROM_FLAG_VERIFY_AFTER_WRITE:	return flashctx->flags.verify_after_write;
 		case FLASHROM_FLAG_VERIFY_WHOLE_CHIP:	return flashctx->flags.verify_whole_chip;
+		case FLASHROM_FLAG_CONSISTENT_READ:	return flashctx->flags.consistent_read;
+		case FLASHROM_FLAG_ERASE_SUSPEND:	return flashctx->flags.erase_suspend;
 		default:				return false;
 	}
 }
@@ -386,6 +392,151 @@ _free_ret:
 #endif
 }
 
+/**
+ * @brief Read a layout from the FMAP stored in the flash chip.
+ *
+ * @param[out] layout Points to a struct flashrom_layout pointer that
+ *                    gets set if the FMAP is read and parsed
+ *                    successfully.
+ * @param[in] flashctx Flash context to read the FMAP from flash.
+ *
+ * @return 0 on success,
+ *         2 if no FMAP was found on the flash chip,
+ *         1 on any other error.
+ */
+int flashrom_layout_read_fmap_from_rom(struct flashrom_layout **const layout, struct flashctx *const flashctx)
+{
+	if (prepare_flash_access(flashctx, true, false, false, false))
+		return 1;
+
+	const int ret = layout_from_fmap_flash(layout, flashctx);
+
+	finalize_flash_access(flashctx);
+	return ret;
+}
+
+/**
+ * @brief Read a layout from the FMAP in an image buffer.
+ *
+ * @param[out] layout Points to a struct flashrom_layout pointer that
+ *                    gets set if the FMAP is found and parsed
+ *                    successfully.
+ * @param[in] flashctx Flash context the layout is meant for. Areas that
+ *                     exceed the flash chip are ignored.
+ * @param[in] buf      The image to search for an FMAP.
+ * @param[in] len      The length of the image.
+ *
+ * @return 0 on success,
+ *         2 if no FMAP was found in the image,
+ *         1 on any other error.
+ */
+int flashrom_layout_read_fmap_from_buffer(struct flashrom_layout **const layout,
+					  const struct flashctx *const flashctx,
+					  const void *const buf, const size_t len)
+{
+	return layout_from_fmap_buffer(layout, buf, len, flashctx->chip->total_size * 1024);
+}
+
+/* Returns the offset of the first byte in [start, end] where `a` and `b` differ, or end + 1. */
+static size_t next_difference(const uint8_t *const a, const uint8_t *const b, size_t start, const size_t end)
+{
+	const size_t chunk = 256;
+
+	/* Let memcmp() skip over identical chunks quickly. */
+	while (start + chunk <= end + 1 && !memcmp(a + start, b + start, chunk))
+		start += chunk;
+	while (start <= end && a[start] == b[start])
+		++start;
+	return start;
+}
+
+/* Returns true if `a` and `b` differ in [start, end] outside of the already included regions. */
+static bool has_uncovered_difference(const struct flashrom_layout *const layout,
+				     const uint8_t *const a, const uint8_t *const b,
+				     const size_t start, const size_t end)
+{
+	size_t addr = start;
+
+	while ((addr = next_difference(a, b, addr, end)) <= end) {
+		size_t i;
+		for (i = 0; i < layout->num_entries; ++i) {
+			const struct romentry *const entry = &layout->entries[i];
+			if (entry->included && entry->start <= addr && addr <= entry->end)
+				break;
+		}
+		if (i == layout->num_entries)
+			return true;
+		/* The difference will be written through that region anyway. */
+		addr = (size_t)layout->entries[i].end + 1;
+	}
+	return false;
+}
+
+static int compare_romentry_size(const void *const a, const void *const b)
+{
+	const struct romentry *const ea = *(const struct romentry *const *)a;
+	const struct romentry *const eb = *(const struct romentry *const *)b;
+	const chipsize_t sa = ea->end - ea->start;
+	const chipsize_t sb = eb->end - eb->start;
+
+	return (sa > sb) - (sa < sb);
+}
+
+/**
+ * @brief Mark all regions as included whose content changes.
+ *
+ * Compares the new image with a reference image that is known to be
+ * the current content of the flash chip (e.g. the image flashed last),
+ * and includes every region that contains a difference. Regions that
+ * are already included stay included.
+ *
+ * For nested regions, like FMAP areas are, the smallest regions that
+ * cover all differences are chosen. This way, only the changed areas
+ * are read, erased and written.
+ *
+ * @param layout    The layout to alter.
+ * @param reference The image that is expected on the flash chip.
+ * @param image     The image that is going to be written.
+ * @param len       The length of both images.
+ *
+ * @return 0 on success,
+ *         1 on any error.
+ */
+int flashrom_layout_include_changed(struct flashrom_layout *const layout,
+				    const void *const reference, const void *const image, const size_t len)
+{
+	const struct romentry **const sorted = malloc(layout->num_entries * sizeof(*sorted));
+	if (layout->num_entries && !sorted) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+
+	size_t i, n;
+	for (i = 0, n = 0; i < layout->num_entries; ++i) {
+		if (layout->entries[i].end < len && layout->entries[i].start <= layout->entries[i].end)
+			sorted[n++] = &layout->entries[i];
+	}
+	qsort(sorted, n, sizeof(*sorted), compare_romentry_size);
+
+	unsigned int changed = 0;
+	for (i = 0; i < n; ++i) {
+		struct romentry *const entry = (struct romentry *)sorted[i];
+		if (entry->included)
+			continue;
+		if (has_uncovered_difference(layout, reference, image, entry->start, entry->end)) {
+			msg_ginfo("%s\"%s\"", changed++ ? ", " : "Changed regions: ", entry->name);
+			entry->included = true;
+		}
+	}
+	if (changed)
+		msg_ginfo(".\n");
+	else
+		msg_ginfo("No region has changed.\n");
+
+	free(sorted);
+	return 0;
+}
+
 /**
  * @brief Free a layout.
  *
@@ -47,6 +47,8 @@ struct flashrom_flashctx;
 int flashrom_flash_probe(struct flashrom_flashctx **, const struct flashrom_programmer *, const char *chip_name);
 size_t flashrom_flash_getsize(const struct flashrom_flashctx *);
 int flashrom_flash_erase(struct flashrom_flashctx *);
+int flashrom_session_begin(struct flashrom_flashctx *);
+void flashrom_session_end(struct flashrom_flashctx *);
 void flashrom_flash_release(struct flashrom_flashctx *);
 
 /** @ingroup flashrom-flash */
@@ -55,6 +57,8 @@ enum flashrom_flag {
 	FLASHROM_FLAG_FORCE_BOARDMISMATCH,
 	FLASHROM_FLAG_VERIFY_AFTER_WRITE,
 	FLASHROM_FLAG_VERIFY_WHOLE_CHIP,
+	FLASHROM_FLAG_CONSISTENT_READ,
+	FLASHROM_FLAG_ERASE_SUSPEND,
 };
 void flashrom_flag_set(struct flashrom_flashctx *, enum flashrom_flag, bool value);
 bool flashrom_flag_get(const struct flashrom_flashctx *, enum flashrom_flag);
@@ -62,13 +66,36 @@ bool flashrom_flag_get(const struct flashrom_flashctx *, enum flashrom_flag);
 int flashrom_image_read(struct flashrom_flashctx *, void *buffer, size_t buffer_len);
 int flashrom_image_write(struct flashrom_flashctx *, void *buffer, size_t buffer_len);
 int flashrom_image_verify(struct flashrom_flashctx *, const void *buffer, size_t buffer_len);
+/** @ingroup flashrom-ops */
+typedef int(flashrom_sink_callback)(void *data, size_t offset, const void *buf, size_t len);
+/** @ingroup flashrom-ops */
+typedef int(flashrom_source_callback)(void *data, size_t offset, void *buf, size_t len);
+int flashrom_image_read_stream(struct flashrom_flashctx *, flashrom_sink_callback *, void *data);
+int flashrom_image_write_stream(struct flashrom_flashctx *, flashrom_source_callback *, void *data);
+/** @ingroup flashrom-ops */
+typedef int(flashrom_delta_callback)(void *data, size_t offset, const void *buf, size_t len);
+int flashrom_image_read_delta(struct flashrom_flashctx *, const void *reference, size_t len,
+			      flashrom_delta_callback *, void *data);
 
 struct flashrom_layout;
 int flashrom_layout_read_from_ifd(struct flashrom_layout **, struct flashrom_flashctx *, const void *dump, size_t len);
+int flashrom_layout_read_fmap_from_rom(struct flashrom_layout **, struct flashrom_flashctx *);
+int flashrom_layout_read_fmap_from_buffer(struct flashrom_layout **, const struct flashrom_flashctx *,
+					  const void *buf, size_t len);
 int flashrom_layout_include_region(struct flashrom_layout *, const char *name);
+int flashrom_layout_include_changed(struct flashrom_layout *, const void *reference, const void *image, size_t len);
 void flashrom_layout_release(struct flashrom_layout *);
 void flashrom_layout_set(struct flashrom_flashctx *, const struct flashrom_layout *);
 
+int flashrom_layout_exclude_up_to_date(struct flashrom_flashctx *, struct flashrom_layout *, const char *hashes,
+				       const void *image, size_t len, unsigned int samples, size_t *remaining);
+char *flashrom_region_hashes_update(const struct flashrom_layout *, const char *old_hashes,
+				    const void *image, size_t len, const char *hash_region);
+int flashrom_region_hashes_read(struct flashrom_flashctx *, const struct flashrom_layout *, const char *region,
+				void *image, size_t len, char **hashes);
+int flashrom_region_hashes_write(struct flashrom_flashctx *, const struct flashrom_layout *, const char *region,
+				 const char *hashes);
+
 /*
  * D-Team args macros
  * Note: number must be larger than ASCII bytes, i.e. larger than 256
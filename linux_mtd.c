@@ -0,0 +1,225 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Accesses flash chips that are driven by a Linux MTD driver (e.g. spi-nor)
+ * through their /dev/mtdX character device. The kernel knows the chip and
+ * the fastest way to talk to it, so flashrom only reads, writes and erases
+ * blocks like on any other opaque master.
+ */
+
+#if CONFIG_LINUX_MTD == 1
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <mtd/mtd-user.h>
+#include "flash.h"
+#include "programmer.h"
+
+static int fd = -1;
+static struct mtd_info_user mtd_info;
+/* Erase regions of chips with differently sized blocks. */
+static struct region_info_user mtd_regions[NUM_ERASEREGIONS];
+static int mtd_region_count;
+
+static int linux_mtd_probe(struct flashctx *flash)
+{
+	struct block_eraser *const eraser = &flash->chip->block_erasers[0];
+	int i;
+
+	flash->chip->total_size = mtd_info.size / 1024;
+	if (!mtd_region_count) {
+		eraser->eraseblocks[0].size = mtd_info.erasesize;
+		eraser->eraseblocks[0].count = mtd_info.size / mtd_info.erasesize;
+		msg_cdbg("MTD device has %u kB in %u erase blocks of %u B each.\n",
+			 mtd_info.size / 1024, mtd_info.size / mtd_info.erasesize, mtd_info.erasesize);
+	} else {
+		for (i = 0; i < mtd_region_count; ++i) {
+			eraser->eraseblocks[i].size = mtd_regions[i].erasesize;
+			eraser->eraseblocks[i].count = mtd_regions[i].numblocks;
+			msg_cdbg("MTD erase region %d at 0x%06x has %u erase blocks of %u B each.\n",
+				 i, mtd_regions[i].offset, mtd_regions[i].numblocks, mtd_regions[i].erasesize);
+		}
+	}
+	/* NOR flash can clear single bits, RAM can do anything. */
+	flash->chip->gran = write_gran_1bit;
+	return 1;
+}
+
+static int linux_mtd_read(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len)
+{
+	while (len) {
+		const ssize_t ret = pread(fd, buf, len, start);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			msg_perr("%s: failed to read %u bytes at 0x%06x: %s\n", __func__, len, start, strerror(errno));
+			return 1;
+		}
+		if (!ret) {
+			msg_perr("%s: unexpected end of device at 0x%06x\n", __func__, start);
+			return 1;
+		}
+		buf += ret;
+		start += ret;
+		len -= ret;
+	}
+	return 0;
+}
+
+static int linux_mtd_write(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len)
+{
+	while (len) {
+		const ssize_t ret = pwrite(fd, buf, len, start);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			msg_perr("%s: failed to write %u bytes at 0x%06x: %s\n", __func__, len, start, strerror(errno));
+			return 1;
+		}
+		if (!ret) {
+			msg_perr("%s: unexpected end of device at 0x%06x\n", __func__, start);
+			return 1;
+		}
+		buf += ret;
+		start += ret;
+		len -= ret;
+	}
+	return 0;
+}
+
+static int linux_mtd_erase(struct flashctx *flash, unsigned int blockaddr, unsigned int blocklen)
+{
+	struct erase_info_user erase = {
+		.start	= blockaddr,
+		.length	= blocklen,
+	};
+
+	if (ioctl(fd, MEMERASE, &erase) == -1) {
+		msg_perr("%s: failed to erase %u bytes at 0x%06x: %s\n",
+			 __func__, blocklen, blockaddr, strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+static const struct opaque_master opaque_master_linux_mtd = {
+	/* The kernel splits transfers as needed. */
+	.max_data_read	= MAX_DATA_UNSPECIFIED,
+	.max_data_write	= MAX_DATA_UNSPECIFIED,
+	.probe		= linux_mtd_probe,
+	.read		= linux_mtd_read,
+	.write		= linux_mtd_write,
+	.erase		= linux_mtd_erase,
+};
+
+static int linux_mtd_shutdown(void *data)
+{
+	if (fd != -1) {
+		close(fd);
+		fd = -1;
+	}
+	return 0;
+}
+
+static int linux_mtd_setup(void)
+{
+	int i;
+
+	if (ioctl(fd, MEMGETINFO, &mtd_info) == -1) {
+		msg_perr("%s: MEMGETINFO failed: %s\n", __func__, strerror(errno));
+		return 1;
+	}
+	msg_pdbg("MTD type %u, flags 0x%x, size %u B, erase size %u B, write size %u B\n",
+		 mtd_info.type, mtd_info.flags, mtd_info.size, mtd_info.erasesize, mtd_info.writesize);
+
+	switch (mtd_info.type) {
+	case MTD_NORFLASH:
+	case MTD_RAM:
+		break;
+	case MTD_NANDFLASH:
+	case MTD_MLCNANDFLASH:
+		msg_perr("NAND flash needs bad block and ECC handling, which flashrom can't do.\n");
+		return 1;
+	default:
+		msg_perr("MTD device type %u is not supported.\n", mtd_info.type);
+		return 1;
+	}
+	if (!(mtd_info.flags & MTD_WRITEABLE))
+		msg_pwarn("MTD device is read-only, writing and erasing will fail.\n");
+	if (mtd_info.writesize > 1) {
+		msg_perr("Write size %u is not supported.\n", mtd_info.writesize);
+		return 1;
+	}
+	if (!mtd_info.erasesize || mtd_info.size % mtd_info.erasesize || mtd_info.size % 1024) {
+		msg_perr("Size %u B is not a multiple of the erase size %u B.\n",
+			 mtd_info.size, mtd_info.erasesize);
+		return 1;
+	}
+
+	if (ioctl(fd, MEMGETREGIONCOUNT, &mtd_region_count) == -1) {
+		msg_pdbg("%s: MEMGETREGIONCOUNT failed, assuming uniform erase blocks: %s\n",
+			 __func__, strerror(errno));
+		mtd_region_count = 0;
+	}
+	if (mtd_region_count > NUM_ERASEREGIONS) {
+		msg_perr("%d erase regions are more than flashrom can handle.\n", mtd_region_count);
+		return 1;
+	}
+	for (i = 0; i < mtd_region_count; ++i) {
+		mtd_regions[i].regionindex = i;
+		if (ioctl(fd, MEMGETREGIONINFO, &mtd_regions[i]) == -1) {
+			msg_perr("%s: MEMGETREGIONINFO failed: %s\n", __func__, strerror(errno));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int linux_mtd_init(void)
+{
+	char *dev = extract_programmer_param("dev");
+	if (!dev || !strlen(dev)) {
+		msg_perr("No MTD device given. Use flashrom -p linux_mtd:dev=/dev/mtdX\n");
+		free(dev);
+		return 1;
+	}
+
+	msg_pdbg("Using device %s\n", dev);
+	fd = open(dev, O_RDWR);
+	if (fd == -1) {
+		msg_perr("%s: failed to open %s: %s\n", __func__, dev, strerror(errno));
+		free(dev);
+		return 1;
+	}
+	free(dev);
+
+	if (register_shutdown(linux_mtd_shutdown, NULL))
+		return 1;
+	/* We rely on the shutdown function for cleanup from here on. */
+
+	if (linux_mtd_setup())
+		return 1;
+
+	return register_opaque_master(&opaque_master_linux_mtd);
+}
+
+#endif
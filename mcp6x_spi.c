@@ -85,6 +85,13 @@ static void mcp6x_bitbang_set_mosi(int val)
 	mmio_writeb(mcp_gpiostate, mcp6x_spibar + 0x530);
 }
 
+static void mcp6x_bitbang_set_sck_set_mosi(int sck, int mosi)
+{
+	mcp_gpiostate &= ~(1 << MCP6X_SPI_SCK | 1 << MCP6X_SPI_MOSI);
+	mcp_gpiostate |= (sck << MCP6X_SPI_SCK) | (mosi << MCP6X_SPI_MOSI);
+	mmio_writeb(mcp_gpiostate, mcp6x_spibar + 0x530);
+}
+
 static int mcp6x_bitbang_get_miso(void)
 {
 	mcp_gpiostate = mmio_readb(mcp6x_spibar + 0x530);
@@ -97,6 +104,7 @@ static const struct bitbang_spi_master bitbang_spi_master_mcp6x = {
 	.set_sck = mcp6x_bitbang_set_sck,
 	.set_mosi = mcp6x_bitbang_set_mosi,
 	.get_miso = mcp6x_bitbang_get_miso,
+	.set_sck_set_mosi = mcp6x_bitbang_set_sck_set_mosi,
 	.request_bus = mcp6x_request_spibus,
 	.release_bus = mcp6x_release_spibus,
 	.half_period = 0,
@@ -111,6 +111,10 @@ const struct dev_entry nics_intel_spi[] = {
 	{0},
 };
 
+/* Cached value of FLA while we own the SPI bus. Only we change the pins, so
+ * setting them doesn't need to read the register back. */
+static uint32_t nicintel_fla;
+
 static void nicintel_request_spibus(void)
 {
 	uint32_t tmp;
@@ -120,46 +124,41 @@ static void nicintel_request_spibus(void)
 	pci_mmio_writel(tmp, nicintel_spibar + FLA);
 
 	/* Wait until we are allowed to use the SPI bus. */
-	while (!(pci_mmio_readl(nicintel_spibar + FLA) & BIT(FL_GNT))) ;
+	while (!((nicintel_fla = pci_mmio_readl(nicintel_spibar + FLA)) & BIT(FL_GNT))) ;
 }
 
 static void nicintel_release_spibus(void)
 {
-	uint32_t tmp;
-
-	tmp = pci_mmio_readl(nicintel_spibar + FLA);
-	tmp &= ~BIT(FL_REQ);
-	pci_mmio_writel(tmp, nicintel_spibar + FLA);
+	nicintel_fla &= ~BIT(FL_REQ);
+	pci_mmio_writel(nicintel_fla, nicintel_spibar + FLA);
 }
 
 static void nicintel_bitbang_set_cs(int val)
 {
-	uint32_t tmp;
-
-	tmp = pci_mmio_readl(nicintel_spibar + FLA);
-	tmp &= ~BIT(FL_CS);
-	tmp |= (val << FL_CS);
-	pci_mmio_writel(tmp,  nicintel_spibar + FLA);
+	nicintel_fla &= ~BIT(FL_CS);
+	nicintel_fla |= (val << FL_CS);
+	pci_mmio_writel(nicintel_fla, nicintel_spibar + FLA);
 }
 
 static void nicintel_bitbang_set_sck(int val)
 {
-	uint32_t tmp;
-
-	tmp = pci_mmio_readl(nicintel_spibar + FLA);
-	tmp &= ~BIT(FL_SCK);
-	tmp |= (val << FL_SCK);
-	pci_mmio_writel(tmp, nicintel_spibar + FLA);
+	nicintel_fla &= ~BIT(FL_SCK);
+	nicintel_fla |= (val << FL_SCK);
+	pci_mmio_writel(nicintel_fla, nicintel_spibar + FLA);
 }
 
 static void nicintel_bitbang_set_mosi(int val)
 {
-	uint32_t tmp;
+	nicintel_fla &= ~BIT(FL_SI);
+	nicintel_fla |= (val << FL_SI);
+	pci_mmio_writel(nicintel_fla, nicintel_spibar + FLA);
+}
 
-	tmp = pci_mmio_readl(nicintel_spibar + FLA);
-	tmp &= ~BIT(FL_SI);
-	tmp |= (val << FL_SI);
-	pci_mmio_writel(tmp, nicintel_spibar + FLA);
+static void nicintel_bitbang_set_sck_set_mosi(int sck, int mosi)
+{
+	nicintel_fla &= ~(BIT(FL_SCK) | BIT(FL_SI));
+	nicintel_fla |= (sck << FL_SCK) | (mosi << FL_SI);
+	pci_mmio_writel(nicintel_fla, nicintel_spibar + FLA);
 }
 
 static int nicintel_bitbang_get_miso(void)
@@ -177,6 +176,7 @@ static const struct bitbang_spi_master bitbang_spi_master_nicintel = {
 	.set_sck = nicintel_bitbang_set_sck,
 	.set_mosi = nicintel_bitbang_set_mosi,
 	.get_miso = nicintel_bitbang_get_miso,
+	.set_sck_set_mosi = nicintel_bitbang_set_sck_set_mosi,
 	.request_bus = nicintel_request_spibus,
 	.release_bus = nicintel_release_spibus,
 	.half_period = 1,
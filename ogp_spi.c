@@ -47,6 +47,10 @@ static uint32_t ogp_reg_siso;
 static uint32_t ogp_reg__ce;
 static uint32_t ogp_reg_sck;
 
+/* Last value written to the SI register, -1 if unknown. Every pin has its own
+ * register, so there is nothing to read back, but repeated bits can be skipped. */
+static int ogp_mosi = -1;
+
 const struct dev_entry ogp_spi[] = {
 	{PCI_VENDOR_ID_OGP, 0x0000, OK, "Open Graphics Project", "Development Board OGD1"},
 
@@ -56,6 +60,7 @@ const struct dev_entry ogp_spi[] = {
 static void ogp_request_spibus(void)
 {
 	pci_mmio_writel(1, ogp_spibar + ogp_reg_sel);
+	ogp_mosi = -1;
 }
 
 static void ogp_release_spibus(void)
@@ -75,7 +80,16 @@ static void ogp_bitbang_set_sck(int val)
 
 static void ogp_bitbang_set_mosi(int val)
 {
+	if (val == ogp_mosi)
+		return;
 	pci_mmio_writel(val, ogp_spibar + ogp_reg_siso);
+	ogp_mosi = val;
+}
+
+static void ogp_bitbang_set_sck_set_mosi(int sck, int mosi)
+{
+	ogp_bitbang_set_sck(sck);
+	ogp_bitbang_set_mosi(mosi);
 }
 
 static int ogp_bitbang_get_miso(void)
@@ -92,6 +106,7 @@ static const struct bitbang_spi_master bitbang_spi_master_ogp = {
 	.set_sck = ogp_bitbang_set_sck,
 	.set_mosi = ogp_bitbang_set_mosi,
 	.get_miso = ogp_bitbang_get_miso,
+	.set_sck_set_mosi = ogp_bitbang_set_sck_set_mosi,
 	.request_bus = ogp_request_spibus,
 	.release_bus = ogp_release_spibus,
 	.half_period = 0,
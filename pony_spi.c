@@ -94,12 +94,42 @@ static int pony_bitbang_get_miso(void)
 	return tmp;
 }
 
+static void pony_bitbang_set_sck_set_mosi(int sck, int mosi)
+{
+	sp_set_dtr_rts(mosi ^ pony_negate_mosi, sck ^ pony_negate_sck);
+}
+
+/* Every pin access is a syscall, so clock whole bytes without the generic
+ * per-bit callbacks and only sample MISO if the caller wants the data. */
+static void pony_bitbang_transfer_bytes(const uint8_t *tx, uint8_t *rx, unsigned int len)
+{
+	unsigned int i;
+	int bit;
+
+	for (i = 0; i < len; i++) {
+		const uint8_t out = tx ? tx[i] : 0;
+		uint8_t in = 0;
+
+		for (bit = 7; bit >= 0; bit--) {
+			pony_bitbang_set_sck_set_mosi(0, (out >> bit) & 1);
+			pony_bitbang_set_sck(1);
+			if (rx)
+				in = in << 1 | pony_bitbang_get_miso();
+		}
+		if (rx)
+			rx[i] = in;
+	}
+	pony_bitbang_set_sck(0);
+}
+
 static const struct bitbang_spi_master bitbang_spi_master_pony = {
 	.type = BITBANG_SPI_MASTER_PONY,
 	.set_cs = pony_bitbang_set_cs,
 	.set_sck = pony_bitbang_set_sck,
 	.set_mosi = pony_bitbang_set_mosi,
 	.get_miso = pony_bitbang_get_miso,
+	.transfer_bytes = pony_bitbang_transfer_bytes,
+	.set_sck_set_mosi = pony_bitbang_set_sck_set_mosi,
 	.half_period = 0,
 };
 
@@ -101,6 +101,9 @@ enum programmer {
 #if CONFIG_LINUX_SPI == 1
 	PROGRAMMER_LINUX_SPI,
 #endif
+#if CONFIG_LINUX_MTD == 1
+	PROGRAMMER_LINUX_MTD,
+#endif
 #if CONFIG_USBBLASTER_SPI == 1
 	PROGRAMMER_USBBLASTER_SPI,
 #endif
@@ -182,6 +185,13 @@ struct bitbang_spi_master {
 	int (*get_miso) (void);
 	void (*request_bus) (void);
 	void (*release_bus) (void);
+	/* Optional: Clock out `len` bytes from `tx` (zeroes if NULL) and store
+	 * the bytes clocked in to `rx` (unless NULL). Only used if half_period
+	 * is 0, to bypass the per-bit callbacks. */
+	void (*transfer_bytes) (const uint8_t *tx, uint8_t *rx, unsigned int len);
+	/* Optional: Set SCK and MOSI at once, e.g. with a single register
+	 * write. Used to shift out the next bit on the falling clock edge. */
+	void (*set_sck_set_mosi) (int sck, int mosi);
 	/* Length of half a clock period in usecs. */
 	unsigned int half_period;
 };
@@ -322,6 +332,7 @@ int cb_check_image(const uint8_t *bios, int size);
 extern int has_dmi_support;
 void dmi_init(void);
 int dmi_match(const char *pattern);
+uint64_t dmi_fingerprint(void);
 #endif // defined(__i386__) || defined(__x86_64__)
 
 /* internal.c */
@@ -532,6 +543,11 @@ int buspirate_spi_init(void);
 int linux_spi_init(void);
 #endif
 
+/* linux_mtd.c */
+#if CONFIG_LINUX_MTD == 1
+int linux_mtd_init(void);
+#endif
+
 /* dediprog.c */
 #if CONFIG_DEDIPROG == 1
 int dediprog_init(void);
@@ -614,6 +630,10 @@ enum spi_controller {
 #define MAX_DATA_WRITE_UNLIMITED 256
 
 #define SPI_MASTER_4BA			(1U << 0)  /**< Can handle 4-byte addresses */
+#define SPI_MASTER_QUAD_IN		(1U << 1)  /**< Can send the data of a quad page program (0x32)
+							on four lines */
+#define SPI_MASTER_QPI			(1U << 2)  /**< Can send and receive everything on four lines
+							while flash->in_qpi_mode is set */
 
 struct spi_master {
 	enum spi_controller type;
@@ -760,6 +780,8 @@ void sp_flush_incoming(void);
 fdtype sp_openserport(char *dev, int baud);
 extern fdtype sp_fd;
 int serialport_config(fdtype fd, int baud);
+unsigned int sp_negotiate_baud(unsigned int baud, const unsigned int *rates,
+			       unsigned int (*request)(unsigned int baud), int (*confirm)(void));
 int serialport_shutdown(void *data);
 int serialport_write(const unsigned char *buf, unsigned int writecnt);
 int serialport_write_nonblock(const unsigned char *buf, unsigned int writecnt, unsigned int timeout, unsigned int *really_wrote);
@@ -791,6 +813,7 @@ enum SP_PIN {
 };
 
 void sp_set_pin(enum SP_PIN pin, int val);
+void sp_set_dtr_rts(int dtr, int rts);
 int sp_get_pin(enum SP_PIN pin);
 
 /* spi_master feature checks */
@@ -800,4 +823,16 @@ static inline bool spi_master_4ba(const struct flashctx *const flash)
 		flash->mst->spi.features & SPI_MASTER_4BA;
 }
 
+static inline bool spi_master_quad_in(const struct flashctx *const flash)
+{
+	return flash->mst->buses_supported & BUS_SPI &&
+		flash->mst->spi.features & SPI_MASTER_QUAD_IN;
+}
+
+static inline bool spi_master_qpi(const struct flashctx *const flash)
+{
+	return flash->mst->buses_supported & BUS_SPI &&
+		flash->mst->spi.features & SPI_MASTER_QPI;
+}
+
 #endif				/* !__PROGRAMMER_H__ */
@@ -160,12 +160,68 @@ static int rayer_bitbang_get_miso(void)
 	return tmp;
 }
 
+/* Port values for all 16 clock edges of each byte value, derived from lpt_seq_base. */
+static uint8_t lpt_seq[256][16];
+static uint8_t lpt_seq_base;
+static int lpt_seq_valid = 0;
+
+static void rayer_build_sequences(uint8_t base)
+{
+	unsigned int val, i;
+
+	for (val = 0; val < 256; val++) {
+		for (i = 0; i < 8; i++) {
+			/* Set MOSI with SCK low, then raise SCK. */
+			const uint8_t lo = base | (((val >> (7 - i)) & 1) << pinout->mosi_bit);
+			lpt_seq[val][2 * i] = lo;
+			lpt_seq[val][2 * i + 1] = lo | (1 << pinout->sck_bit);
+		}
+	}
+	lpt_seq_base = base;
+	lpt_seq_valid = 1;
+}
+
+/* Clocks whole bytes with back-to-back port writes. Only valid without delays. */
+static void rayer_bitbang_transfer_bytes(const uint8_t *tx, uint8_t *rx, unsigned int len)
+{
+	const uint8_t base = lpt_outbyte & ~((1 << pinout->sck_bit) | (1 << pinout->mosi_bit));
+	const uint8_t *seq = NULL;
+	unsigned int i, j;
+
+	if (!len)
+		return;
+	if (!lpt_seq_valid || base != lpt_seq_base)
+		rayer_build_sequences(base);
+
+	for (i = 0; i < len; i++) {
+		seq = lpt_seq[tx ? tx[i] : 0];
+		if (rx) {
+			uint8_t in = 0;
+			for (j = 0; j < 16; j += 2) {
+				OUTB(seq[j], lpt_iobase);
+				OUTB(seq[j + 1], lpt_iobase);
+				/* Sample MISO right after the rising edge. */
+				in = (in << 1) | (((INB(lpt_iobase + 1) ^ 0x80) >> pinout->miso_bit) & 1);
+			}
+			rx[i] = in;
+		} else {
+			for (j = 0; j < 16; j++)
+				OUTB(seq[j], lpt_iobase);
+		}
+	}
+
+	/* Leave SCK low like the per-bit callbacks do. */
+	lpt_outbyte = seq[14];
+	OUTB(lpt_outbyte, lpt_iobase);
+}
+
 static const struct bitbang_spi_master bitbang_spi_master_rayer = {
 	.type = BITBANG_SPI_MASTER_RAYER,
 	.set_cs = rayer_bitbang_set_cs,
 	.set_sck = rayer_bitbang_set_sck,
 	.set_mosi = rayer_bitbang_set_mosi,
 	.get_miso = rayer_bitbang_get_miso,
+	.transfer_bytes = rayer_bitbang_transfer_bytes,
 	.half_period = 0,
 };
 
@@ -224,6 +280,8 @@ int rayer_spi_init(void)
 	}
 	msg_pinfo("Using %s pinout.\n", prog->description);
 	pinout = (struct rayer_pinout *)prog->dev_data;
+	/* The precomputed sequences depend on the pinout. */
+	lpt_seq_valid = 0;
 
 	if (rget_io_perms())
 		return 1;
@@ -0,0 +1,421 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Region hashes record a hash per layout region as last written by
+ * flashrom. They are kept as text, one region per line:
+ *
+ *   <start>:<end> <hash> <name>
+ *
+ * with start, end and hash in hexadecimal. The same text is used for a
+ * sidecar file and for a dedicated region on the flash chip, where it is
+ * padded with erased bytes.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "flash.h"
+#include "layout.h"
+#include "libflashrom.h"
+
+#define REGION_HASHES_HEADER	"# flashrom region hashes v1\n"
+/* Bytes read per sample in sampled verification. */
+#define REGION_SAMPLE_SIZE	256
+
+struct region_hash {
+	chipoff_t start;
+	chipoff_t end;
+	uint64_t hash;
+	char name[256];
+};
+
+/* Parses `text` into a newly allocated array of records. Malformed lines are ignored. */
+static int parse_region_hashes(const char *text, struct region_hash **const records, size_t *const count)
+{
+	size_t lines = 1, n = 0;
+	const char *p;
+
+	for (p = text; *p; ++p)
+		lines += *p == '\n';
+
+	*records = malloc(lines * sizeof(**records));
+	if (!*records) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+
+	while (*text) {
+		const char *const eol = strchr(text, '\n');
+		const size_t len = eol ? (size_t)(eol - text) : strlen(text);
+		char line[512];
+
+		if (len < sizeof(line) && *text != '#') {
+			struct region_hash *const r = &(*records)[n];
+			memcpy(line, text, len);
+			line[len] = '\0';
+			if (sscanf(line, "%" SCNx32 ":%" SCNx32 " %" SCNx64 " %255[^\n]",
+				   &r->start, &r->end, &r->hash, r->name) == 4)
+				++n;
+			else if (len)
+				msg_gdbg("Ignoring malformed region hash \"%s\".\n", line);
+		}
+		text += len + !!eol;
+	}
+
+	*count = n;
+	return 0;
+}
+
+static const struct region_hash *find_region_hash(const struct region_hash *const records, const size_t count,
+						  const struct romentry *const entry)
+{
+	size_t i;
+
+	for (i = 0; i < count; ++i) {
+		if (records[i].start == entry->start && records[i].end == entry->end &&
+		    !strcmp(records[i].name, entry->name))
+			return &records[i];
+	}
+	return NULL;
+}
+
+static const struct romentry *find_region(const struct flashrom_layout *const layout, const char *const name)
+{
+	size_t i;
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		if (!strcmp(layout->entries[i].name, name))
+			return &layout->entries[i];
+	}
+	msg_gerr("Region \"%s\" not found in layout.\n", name);
+	return NULL;
+}
+
+static bool ranges_overlap(const chipoff_t start1, const chipoff_t end1, const chipoff_t start2, const chipoff_t end2)
+{
+	return start1 <= end2 && start2 <= end1;
+}
+
+/* Compares a few random chunks of a region on the flash chip with the image. Returns 0 if all match. */
+static int sample_region(struct flashctx *const flashctx, const struct romentry *const entry,
+			 const uint8_t *const image, const unsigned int samples, uint64_t *const seed)
+{
+	const chipsize_t size = entry->end - entry->start + 1;
+	uint8_t buf[REGION_SAMPLE_SIZE];
+	unsigned int i;
+
+	for (i = 0; i < samples; ++i) {
+		/* xorshift64, good enough to pick offsets */
+		*seed ^= *seed << 13;
+		*seed ^= *seed >> 7;
+		*seed ^= *seed << 17;
+
+		const chipsize_t len = min(size, REGION_SAMPLE_SIZE);
+		const chipoff_t off = entry->start + (*seed % (size - len + 1));
+		if (flashctx->chip->read(flashctx, buf, off, len)) {
+			msg_cerr("Read operation failed!\n");
+			return 1;
+		}
+		if (memcmp(buf, image + off, len)) {
+			msg_cdbg("Sample at 0x%06x of region \"%s\" differs.\n", off, entry->name);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Exclude regions from a layout that are already up to date.
+ *
+ * Every included region whose hash in `hashes` matches the image is
+ * excluded, so that it will neither be read, nor erased or written.
+ * Optionally, a few random chunks of each such region are read back
+ * and compared to guard against changes that were made behind
+ * flashrom's back.
+ *
+ * @param flashctx The flash context, only used for sampled verification.
+ * @param layout   The layout to alter. If NULL, the whole chip is
+ *                 treated as a single region "complete flash".
+ * @param hashes   The region hashes as last written by flashrom, may be
+ *                 NULL if there are none.
+ * @param image    The image that is going to be written.
+ * @param len      The length of the image, must match the flash size.
+ * @param samples  Number of chunks to sample per matching region, 0 to
+ *                 trust the hashes.
+ * @param[out] remaining Set to the number of included regions that
+ *                       still need to be written.
+ *
+ * @return 0 on success,
+ *         1 on any error.
+ */
+int flashrom_layout_exclude_up_to_date(struct flashrom_flashctx *const flashctx, struct flashrom_layout *layout,
+				       const char *const hashes, const void *const image, const size_t len,
+				       const unsigned int samples, size_t *const remaining)
+{
+	struct romentry whole = { .start = 0, .end = len - 1, .included = true, .name = "complete flash" };
+	struct flashrom_layout whole_layout = { .entries = &whole, .num_entries = 1 };
+	struct region_hash *records = NULL;
+	size_t count = 0, i;
+	bool prepared = false;
+	uint64_t seed = (uint64_t)time(NULL) | 1;
+	int ret = 1;
+
+	if (len != flashctx->chip->total_size * 1024)
+		return 1;
+	if (!layout)
+		layout = &whole_layout;
+
+	*remaining = 0;
+	if (hashes && parse_region_hashes(hashes, &records, &count))
+		return 1;
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		struct romentry *const entry = &layout->entries[i];
+		if (!entry->included)
+			continue;
+
+		const struct region_hash *const r = find_region_hash(records, count, entry);
+		if (!r || entry->end >= len ||
+		    r->hash != fnv1a_64((const uint8_t *)image + entry->start, entry->end - entry->start + 1)) {
+			++*remaining;
+			continue;
+		}
+
+		if (samples) {
+			if (!prepared) {
+				if (prepare_flash_access(flashctx, true, false, false, false))
+					goto _free_ret;
+				prepared = true;
+			}
+			if (sample_region(flashctx, entry, image, samples, &seed)) {
+				msg_cinfo("Region \"%s\" doesn't match its recorded hash on the chip.\n",
+					  entry->name);
+				++*remaining;
+				continue;
+			}
+		}
+
+		msg_ginfo("Region \"%s\" is up to date, skipping it.\n", entry->name);
+		entry->included = false;
+	}
+	ret = 0;
+
+_free_ret:
+	if (prepared)
+		finalize_flash_access(flashctx);
+	free(records);
+	return ret;
+}
+
+/**
+ * @brief Compute the region hashes after a successful write.
+ *
+ * Regions that are included in the layout are recorded with the hash of
+ * the written image. Records of other regions are kept, unless they
+ * overlap a written region or the region that stores the hashes.
+ *
+ * @param layout      The layout that was written. If NULL, the whole
+ *                    chip was written.
+ * @param old_hashes  The previous region hashes, may be NULL.
+ * @param image       The image that was written.
+ * @param len         The length of the image.
+ * @param hash_region Name of the region that stores the hashes, or NULL.
+ *
+ * @return The new region hashes, to be freed by the caller, or
+ *         NULL on error.
+ */
+char *flashrom_region_hashes_update(const struct flashrom_layout *layout, const char *const old_hashes,
+				    const void *const image, const size_t len, const char *const hash_region)
+{
+	struct romentry whole = { .start = 0, .end = len - 1, .included = true, .name = "complete flash" };
+	const struct flashrom_layout whole_layout = { .entries = &whole, .num_entries = 1 };
+	const struct romentry *skip = NULL;
+	struct region_hash *records = NULL;
+	size_t count = 0, i, j;
+	char *text = NULL;
+
+	if (!layout)
+		layout = &whole_layout;
+	if (hash_region && !(skip = find_region(layout, hash_region)))
+		return NULL;
+	if (old_hashes && parse_region_hashes(old_hashes, &records, &count))
+		return NULL;
+
+	/* A line takes at most 8 + 1 + 8 + 1 + 16 + 1 + 255 + 1 bytes. */
+	const size_t max_len = sizeof(REGION_HASHES_HEADER) + (layout->num_entries + count) * 300;
+	text = malloc(max_len);
+	if (!text) {
+		msg_gerr("Out of memory!\n");
+		goto _free_ret;
+	}
+	size_t pos = snprintf(text, max_len, "%s", REGION_HASHES_HEADER);
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		const struct romentry *const entry = &layout->entries[i];
+		if (!entry->included || entry->end >= len)
+			continue;
+		if (skip && ranges_overlap(entry->start, entry->end, skip->start, skip->end))
+			continue;
+		pos += snprintf(text + pos, max_len - pos, "%08" PRIx32 ":%08" PRIx32 " %016" PRIx64 " %s\n",
+				entry->start, entry->end,
+				fnv1a_64((const uint8_t *)image + entry->start, entry->end - entry->start + 1),
+				entry->name);
+	}
+
+	for (i = 0; i < count; ++i) {
+		const struct region_hash *const r = &records[i];
+		if (skip && ranges_overlap(r->start, r->end, skip->start, skip->end))
+			continue;
+		for (j = 0; j < layout->num_entries; ++j) {
+			if (layout->entries[j].included &&
+			    ranges_overlap(r->start, r->end, layout->entries[j].start, layout->entries[j].end))
+				break;
+		}
+		if (j < layout->num_entries)
+			continue;
+		pos += snprintf(text + pos, max_len - pos, "%08" PRIx32 ":%08" PRIx32 " %016" PRIx64 " %s\n",
+				r->start, r->end, r->hash, r->name);
+	}
+
+_free_ret:
+	free(records);
+	return text;
+}
+
+/**
+ * @brief Read the region hashes stored in a region of the flash chip.
+ *
+ * Only the given region is read. Its contents are also copied into the
+ * image buffer, so that the region compares equal when the whole chip
+ * is verified after writing the image.
+ *
+ * @param flashctx The flash context to read from.
+ * @param layout   The layout that contains the region.
+ * @param region   Name of the region that stores the hashes.
+ * @param image    A buffer of full flash size, the region's contents are
+ *                 copied into it.
+ * @param len      The length of the buffer.
+ * @param[out] hashes Set to the stored hashes, to be freed by the caller.
+ *
+ * @return 0 on success,
+ *         1 on any error.
+ */
+int flashrom_region_hashes_read(struct flashrom_flashctx *const flashctx, const struct flashrom_layout *const layout,
+				const char *const region, void *const image, const size_t len, char **const hashes)
+{
+	const struct romentry *const entry = find_region(layout, region);
+	if (!entry)
+		return 1;
+	if (len != flashctx->chip->total_size * 1024 || entry->end >= len)
+		return 1;
+
+	const chipsize_t size = entry->end - entry->start + 1;
+	char *const text = malloc(size + 1);
+	if (!text) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+
+	if (prepare_flash_access(flashctx, true, false, false, false)) {
+		free(text);
+		return 1;
+	}
+	msg_cinfo("Reading region hashes from \"%s\"... ", region);
+	const int ret = flashctx->chip->read(flashctx, (uint8_t *)image + entry->start, entry->start, size);
+	finalize_flash_access(flashctx);
+	if (ret) {
+		msg_cinfo("FAILED.\n");
+		free(text);
+		return 1;
+	}
+	msg_cinfo("done.\n");
+
+	/* The text ends at the first erased or NUL byte. */
+	chipsize_t i;
+	for (i = 0; i < size; ++i) {
+		const char c = ((const char *)image)[entry->start + i];
+		if (c == '\0' || c == (char)0xff)
+			break;
+		text[i] = c;
+	}
+	text[i] = '\0';
+
+	*hashes = text;
+	return 0;
+}
+
+/**
+ * @brief Store region hashes in a region of the flash chip.
+ *
+ * Only the given region is erased and written, regardless of the
+ * regions included in the layout.
+ *
+ * @param flashctx The flash context to write to.
+ * @param layout   The layout that contains the region.
+ * @param region   Name of the region that stores the hashes.
+ * @param hashes   The region hashes to store.
+ *
+ * @return 0 on success,
+ *         1 if the hashes don't fit into the region or on any other error.
+ */
+int flashrom_region_hashes_write(struct flashrom_flashctx *const flashctx, const struct flashrom_layout *const layout,
+				 const char *const region, const char *const hashes)
+{
+	const size_t flash_size = flashctx->chip->total_size * 1024;
+	const struct romentry *const entry = find_region(layout, region);
+	if (!entry)
+		return 1;
+
+	const size_t text_len = strlen(hashes);
+	if (entry->end >= flash_size || text_len > entry->end - entry->start + 1) {
+		msg_gerr("Region hashes (%zu bytes) don't fit into region \"%s\".\n", text_len, region);
+		return 1;
+	}
+
+	uint8_t *const buf = malloc(flash_size);
+	if (!buf) {
+		msg_gerr("Out of memory!\n");
+		return 1;
+	}
+	/* Everything outside the hash region isn't written, but may still be looked at. */
+	memset(buf, 0xff, flash_size);
+	memcpy(buf + entry->start, hashes, text_len);
+
+	/* Temporarily write through a layout that includes only the hash region. */
+	struct single_layout hash_layout = {
+		.base = { .entries = &hash_layout.entry, .num_entries = 1 },
+		.entry = *entry,
+	};
+	hash_layout.entry.included = true;
+
+	const struct flashrom_layout *const saved_layout = flashctx->layout;
+	const bool saved_verify_all = flashctx->flags.verify_whole_chip;
+	flashctx->layout = &hash_layout.base;
+	flashctx->flags.verify_whole_chip = false;
+
+	msg_cinfo("Writing region hashes to \"%s\".\n", region);
+	const int ret = flashrom_image_write(flashctx, buf, flash_size);
+
+	flashctx->layout = saved_layout;
+	flashctx->flags.verify_whole_chip = saved_verify_all;
+	free(buf);
+	return ret ? 1 : 0;
+}
@@ -44,6 +44,13 @@
 
 fdtype sp_fd = SER_INV_FD;
 
+#if !IS_WINDOWS
+/* Modem control lines as last set by us. Nobody else drives the outputs, so
+ * they only need to be read once per port instead of before every change. */
+static int sp_modem_ctl;
+static bool sp_modem_ctl_valid = false;
+#endif
+
 /* There is no way defined by POSIX to use arbitrary baud rates. It only defines some macros that can be used to
  * specify respective baud rates and many implementations extend this list with further macros, cf. TERMIOS(3)
  * and http://git.kernel.org/?p=linux/kernel/git/torvalds/linux.git;a=blob;f=include/uapi/asm-generic/termbits.h
@@ -218,7 +225,8 @@ int serialport_config(fdtype fd, int baud)
 	wanted.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG | IEXTEN);
 	wanted.c_iflag &= ~(IXON | IXOFF | IXANY | ICRNL | IGNCR | INLCR);
 	wanted.c_oflag &= ~OPOST;
-	if (tcsetattr(fd, TCSANOW, &wanted) != 0) {
+	/* Let pending output leave at the old rate, the device may switch right after it. */
+	if (tcsetattr(fd, TCSADRAIN, &wanted) != 0) {
 		msg_perr_strerror("Could not change serial port configuration: ");
 		return 1;
 	}
@@ -304,6 +312,7 @@ fdtype sp_openserport(char *dev, int baud)
 	if (serialport_config(fd, baud) != 0) {
 		goto err;
 	}
+	sp_modem_ctl_valid = false;
 	return fd;
 err:
 	close(fd);
@@ -311,6 +320,75 @@ err:
 #endif
 }
 
+/*
+ * Steps the link up through the rates in the ascending, 0-terminated list `rates` that are faster than
+ * `baud`, the rate the link currently works at. For each rate, `request` asks the device to switch and
+ * returns the rate the device actually uses, or 0 if it refuses. Refused rates are skipped. Otherwise the
+ * host follows and `confirm` checks the link with some protocol echo. The first rate that fails the check
+ * ends the search: the host returns to the last working rate, where `confirm` must be able to bring the
+ * device back as well.
+ *
+ * Returns the rate the link works at afterwards, or 0 if it was lost.
+ */
+unsigned int sp_negotiate_baud(unsigned int baud, const unsigned int *rates,
+			       unsigned int (*request)(unsigned int baud), int (*confirm)(void))
+{
+	int i;
+
+	for (i = 0; rates[i]; i++) {
+		if (rates[i] <= baud)
+			continue;
+		const unsigned int new_baud = request(rates[i]);
+		if (!new_baud) {
+			msg_pdbg("Device refused %u baud.\n", rates[i]);
+			continue;
+		}
+		if (!serialport_config(sp_fd, new_baud) && !confirm()) {
+			msg_pdbg("Link works at %u baud.\n", new_baud);
+			baud = new_baud;
+			continue;
+		}
+		msg_pdbg("Link doesn't work at %u baud, going back to %u baud.\n", new_baud, baud);
+		if (serialport_config(sp_fd, baud) || confirm()) {
+			msg_perr("Error: Lost the link while changing the baud rate, please reset the device.\n");
+			return 0;
+		}
+		break;
+	}
+	return baud;
+}
+
+/* Sets DTR and RTS together, a value of -1 leaves the respective line as is. */
+void sp_set_dtr_rts(int dtr, int rts)
+{
+#if IS_WINDOWS
+	if (dtr >= 0)
+		EscapeCommFunction(sp_fd, dtr ? SETDTR : CLRDTR);
+	if (rts >= 0)
+		EscapeCommFunction(sp_fd, rts ? SETRTS : CLRRTS);
+#else
+	int ctl;
+
+	if (!sp_modem_ctl_valid) {
+		if (ioctl(sp_fd, TIOCMGET, &sp_modem_ctl))
+			return;
+		sp_modem_ctl_valid = true;
+	}
+
+	ctl = sp_modem_ctl;
+	if (dtr >= 0)
+		ctl = dtr ? (ctl | TIOCM_DTR) : (ctl & ~TIOCM_DTR);
+	if (rts >= 0)
+		ctl = rts ? (ctl | TIOCM_RTS) : (ctl & ~TIOCM_RTS);
+	if (ctl == sp_modem_ctl)
+		return;
+
+	/* One ioctl for both lines, so they change at the same time. */
+	ioctl(sp_fd, TIOCMSET, &ctl);
+	sp_modem_ctl = ctl;
+#endif
+}
+
 void sp_set_pin(enum SP_PIN pin, int val) {
 #if IS_WINDOWS
 	DWORD ctl;
@@ -326,22 +404,14 @@ void sp_set_pin(enum SP_PIN pin, int val) {
 	}
 	EscapeCommFunction(sp_fd, ctl);
 #else
-	int ctl, s;
-
 	if(pin == PIN_TXD) {
 		ioctl(sp_fd, val ? TIOCSBRK : TIOCCBRK, 0);
 	}
+	else if (pin == PIN_DTR) {
+		sp_set_dtr_rts(val, -1);
+	}
 	else {
-		s = (pin == PIN_DTR) ? TIOCM_DTR : TIOCM_RTS;
-		ioctl(sp_fd, TIOCMGET, &ctl);
-
-		if (val) {
-			ctl |= s;
-		}
-		else {
-			ctl &= ~s;
-		}
-		ioctl(sp_fd, TIOCMSET, &ctl);
+		sp_set_dtr_rts(-1, val);
 	}
 #endif
 }
@@ -380,6 +450,7 @@ int serialport_shutdown(void *data)
 	CloseHandle(sp_fd);
 #else
 	close(sp_fd);
+	sp_modem_ctl_valid = false;
 #endif
 	return 0;
 }
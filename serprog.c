@@ -85,6 +85,22 @@ static int sp_opbuf_usage = 0;
 	whether the command is supported before doing it */
 static int sp_check_avail_automatic = 0;
 
+/* Baud rate the serial port was opened with and the one used now, 0 if unknown. */
+static unsigned int sp_initial_baud = 0;
+static unsigned int sp_baud = 0;
+/* Rates tried by autobaud=yes, in ascending order. */
+static const unsigned int sp_autobaud_rates[] = {
+	230400, 460800, 500000, 921600, 1000000, 1500000, 2000000, 3000000, 4000000, 0
+};
+
+/* Packed transfers are used if the device supports them, unless compress=no was given. */
+static int sp_pack_enabled = 0;
+/* Shorter transfers are sent raw, the extra length fields would eat up the savings. */
+#define SP_PACK_MIN 32
+/* Payload bytes moved by packed commands and the bytes they took on the wire. */
+static unsigned long long sp_pack_raw_bytes;
+static unsigned long long sp_pack_wire_bytes;
+
 #if ! IS_WINDOWS
 static int sp_opensocket(char *ip, unsigned int port)
 {
@@ -193,6 +209,25 @@ err_out:
 	return 1;
 }
 
+/* Checks the link with SYNCNOPs for up to about 1.5 s. That is longer than the programmer waits for the
+ * first SYNCNOP after S_CMD_S_UART_SPEED before it returns to its previous rate. */
+static int sp_check_link(void)
+{
+	int i;
+	unsigned char c[2];
+
+	sp_flush_incoming();
+	for (i = 0; i < 15; i++) {
+		c[0] = S_CMD_SYNCNOP;
+		if (serialport_write_nonblock(c, 1, 10, NULL) < 0)
+			return 1;
+		if (!serialport_read_nonblock(c, 2, 100, NULL) && c[0] == S_NAK && c[1] == S_ACK)
+			return 0;
+		sp_flush_incoming();
+	}
+	return 1;
+}
+
 static int sp_check_commandavail(uint8_t command)
 {
 	int byteoffs, bitoffs;
@@ -244,6 +279,20 @@ static int sp_docommand(uint8_t command, uint32_t parmlen,
 	return 0;
 }
 
+/* Asks the programmer to switch its UART to `baud`. Returns the rate it uses, 0 if it refused. */
+static unsigned int sp_request_baud(unsigned int baud)
+{
+	uint8_t buf[4];
+
+	buf[0] = (baud >> (0 * 8)) & 0xFF;
+	buf[1] = (baud >> (1 * 8)) & 0xFF;
+	buf[2] = (baud >> (2 * 8)) & 0xFF;
+	buf[3] = (baud >> (3 * 8)) & 0xFF;
+	if (sp_docommand(S_CMD_S_UART_SPEED, 4, buf, 4, buf))
+		return 0;
+	return buf[0] | buf[1] << (1 * 8) | buf[2] << (2 * 8) | (uint32_t)buf[3] << (3 * 8);
+}
+
 static int sp_flush_stream(void)
 {
 	if (sp_streamed_transmit_ops)
@@ -299,6 +348,191 @@ static int sp_stream_buffer_op(uint8_t cmd, uint32_t parmlen, uint8_t *parms)
 	return 0;
 }
 
+/*
+ * Packed data is a sequence of tokens, see serprog-protocol.txt:
+ *   0x00-0x7F: c + 1 literal bytes follow.
+ *   0x80-0xBF: fill, ((c & 0x3F) << 8 | next byte) + 1 copies of the byte after that.
+ *   0xC0-0xFF: copy (c & 0x3F) + 4 bytes from (16-bit distance + 1) bytes back, may overlap.
+ * Copies never reach outside the data of the current command.
+ */
+#define SP_PACK_LIT_MAX		128
+#define SP_PACK_FILL_MAX	(1 << 14)
+#define SP_PACK_COPY_MIN	4
+#define SP_PACK_COPY_MAX	(0x3F + SP_PACK_COPY_MIN)
+#define SP_PACK_DIST_MAX	(1 << 16)
+#define SP_PACK_HASH_BITS	10
+
+/* Worst case size of `len` bytes packed: all literals. */
+static uint32_t sp_pack_bound(uint32_t len)
+{
+	return len + len / SP_PACK_LIT_MAX + 1;
+}
+
+static uint32_t sp_pack_flush_literals(uint8_t *dst, const uint8_t *lit, uint32_t litlen)
+{
+	if (!litlen)
+		return 0;
+	dst[0] = litlen - 1;
+	memcpy(dst + 1, lit, litlen);
+	return 1 + litlen;
+}
+
+/* Packs `len` bytes from `src` into `dst`, which must hold sp_pack_bound(len) bytes. Returns the packed size. */
+static uint32_t sp_pack(uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+	/* Last position + 1 of each hashed 4-byte sequence. */
+	uint32_t table[1 << SP_PACK_HASH_BITS] = { 0 };
+	uint32_t i = 0, lit = 0, litlen = 0, out = 0;
+
+	while (i < len) {
+		uint32_t n = 1;
+
+		while (i + n < len && n < SP_PACK_FILL_MAX && src[i + n] == src[i])
+			n++;
+		if (n >= SP_PACK_COPY_MIN) {
+			out += sp_pack_flush_literals(dst + out, src + lit, litlen);
+			litlen = 0;
+			dst[out++] = 0x80 | (n - 1) >> 8;
+			dst[out++] = (n - 1) & 0xFF;
+			dst[out++] = src[i];
+			i += n;
+			continue;
+		}
+		if (i + SP_PACK_COPY_MIN <= len) {
+			const uint32_t v = src[i] | src[i + 1] << 8 | src[i + 2] << 16 | (uint32_t)src[i + 3] << 24;
+			const uint32_t h = (v * 2654435761U) >> (32 - SP_PACK_HASH_BITS);
+			const uint32_t cand = table[h];
+
+			table[h] = i + 1;
+			if (cand && i - (cand - 1) <= SP_PACK_DIST_MAX &&
+			    !memcmp(src + cand - 1, src + i, SP_PACK_COPY_MIN)) {
+				const uint32_t dist = i - (cand - 1) - 1;
+
+				n = SP_PACK_COPY_MIN;
+				while (i + n < len && n < SP_PACK_COPY_MAX && src[cand - 1 + n] == src[i + n])
+					n++;
+				out += sp_pack_flush_literals(dst + out, src + lit, litlen);
+				litlen = 0;
+				dst[out++] = 0xC0 | (n - SP_PACK_COPY_MIN);
+				dst[out++] = dist & 0xFF;
+				dst[out++] = dist >> 8;
+				i += n;
+				continue;
+			}
+		}
+		if (!litlen)
+			lit = i;
+		if (++litlen == SP_PACK_LIT_MAX) {
+			out += sp_pack_flush_literals(dst + out, src + lit, litlen);
+			litlen = 0;
+		}
+		i++;
+	}
+	out += sp_pack_flush_literals(dst + out, src + lit, litlen);
+	return out;
+}
+
+/* Unpacks `srclen` bytes from `src`, which must yield exactly `len` bytes in `dst`. */
+static int sp_unpack(uint8_t *dst, uint32_t len, const uint8_t *src, uint32_t srclen)
+{
+	uint32_t i = 0, out = 0;
+
+	while (i < srclen) {
+		const uint8_t c = src[i++];
+		uint32_t n;
+
+		if (c < 0x80) {
+			n = c + 1;
+			if (i + n > srclen || out + n > len)
+				goto err;
+			memcpy(dst + out, src + i, n);
+			i += n;
+		} else if (c < 0xC0) {
+			if (i + 2 > srclen)
+				goto err;
+			n = ((c & 0x3F) << 8 | src[i]) + 1;
+			if (out + n > len)
+				goto err;
+			memset(dst + out, src[i + 1], n);
+			i += 2;
+		} else {
+			uint32_t dist, j;
+
+			if (i + 2 > srclen)
+				goto err;
+			n = (c & 0x3F) + SP_PACK_COPY_MIN;
+			dist = (src[i] | src[i + 1] << 8) + 1;
+			if (dist > out || out + n > len)
+				goto err;
+			/* Byte by byte, overlapping copies repeat a pattern. */
+			for (j = 0; j < n; j++)
+				dst[out + j] = dst[out - dist + j];
+			i += 2;
+		}
+		out += n;
+	}
+	if (out == len)
+		return 0;
+err:
+	msg_perr(MSGHEADER "Error: corrupt packed data (%u of %u bytes unpacked)\n", out, len);
+	return 1;
+}
+
+static int sp_use_packed(uint8_t cmd, uint32_t len)
+{
+	return sp_pack_enabled && len >= SP_PACK_MIN && sp_check_commandavail(cmd);
+}
+
+/* Reads and drops `len` bytes, so that the stream stays in step after a reply is rejected. */
+static int sp_skip_incoming(uint32_t len)
+{
+	uint8_t tmp[256];
+
+	while (len) {
+		const uint32_t n = len < sizeof(tmp) ? len : sizeof(tmp);
+		if (serialport_read(tmp, n) != 0)
+			return 1;
+		len -= n;
+	}
+	return 0;
+}
+
+/* Reads a 24-bit packed length and the packed data following it, and unpacks `len` bytes into `buf`. */
+static int sp_read_packed(uint8_t *buf, uint32_t len)
+{
+	uint8_t hdr[3];
+	uint8_t *packed;
+	uint32_t plen;
+	int ret = 1;
+
+	if (serialport_read(hdr, 3) != 0) {
+		msg_perr(MSGHEADER "Error: cannot read packed length\n");
+		return 1;
+	}
+	plen = hdr[0] | hdr[1] << 8 | hdr[2] << 16;
+	if (plen > sp_pack_bound(len)) {
+		msg_perr(MSGHEADER "Error: packed length %u is too big for %u bytes\n", plen, len);
+		sp_skip_incoming(plen);
+		return 1;
+	}
+	packed = malloc(plen);
+	if (!packed) {
+		msg_perr(MSGHEADER "Error: cannot allocate packed read buffer\n");
+		sp_skip_incoming(plen);
+		return 1;
+	}
+	if (serialport_read(packed, plen) != 0) {
+		msg_perr(MSGHEADER "Error: cannot read packed data\n");
+		goto out;
+	}
+	ret = sp_unpack(buf, len, packed, plen);
+	sp_pack_raw_bytes += len;
+	sp_pack_wire_bytes += 3 + plen;
+out:
+	free(packed);
+	return ret;
+}
+
 static int serprog_spi_send_command(struct flashctx *flash,
 				    unsigned int writecnt, unsigned int readcnt,
 				    const unsigned char *writearr,
@@ -342,6 +576,30 @@ int serprog_init(void)
 	unsigned char c;
 	char *device;
 	int have_device = 0;
+	int autobaud = 0;
+
+	sp_initial_baud = sp_baud = 0;
+	device = extract_programmer_param("autobaud");
+	if (device && !strcmp(device, "yes")) {
+		autobaud = 1;
+	} else if (device) {
+		msg_perr("Error: Invalid autobaud value \"%s\" (not \"yes\").\n", device);
+		free(device);
+		return 1;
+	}
+	free(device);
+
+	sp_pack_enabled = 1;
+	sp_pack_raw_bytes = sp_pack_wire_bytes = 0;
+	device = extract_programmer_param("compress");
+	if (device && !strcmp(device, "no")) {
+		sp_pack_enabled = 0;
+	} else if (device && strcmp(device, "yes")) {
+		msg_perr("Error: Invalid compress value \"%s\" (not \"yes\" or \"no\").\n", device);
+		free(device);
+		return 1;
+	}
+	free(device);
 
 	/* the parameter is either of format "dev=/dev/device[:baud]" or "ip=ip:port" */
 	device = extract_programmer_param("dev");
@@ -367,6 +625,8 @@ int serprog_init(void)
 				free(device);
 				return 1;
 			}
+			if (baud > 0)
+				sp_initial_baud = sp_baud = baud;
 			have_device++;
 		}
 	}
@@ -461,6 +721,30 @@ int serprog_init(void)
 
 	sp_check_avail_automatic = 1;
 
+	if (sp_pack_enabled) {
+		if (!sp_check_commandavail(S_CMD_O_SPIOP_PACKED) &&
+		    !sp_check_commandavail(S_CMD_R_NBYTES_PACKED) &&
+		    !sp_check_commandavail(S_CMD_O_WRITEN_PACKED)) {
+			msg_pdbg(MSGHEADER "Packed transfers not supported\n");
+			sp_pack_enabled = 0;
+		} else
+			msg_pdbg(MSGHEADER "Using packed transfers\n");
+	}
+
+	if (autobaud) {
+		if (!sp_baud) {
+			msg_pwarn(MSGHEADER "Warning: autobaud needs a starting rate, "
+				  "use dev=/dev/device:baud.\n");
+		} else if (sp_check_commandavail(S_CMD_S_UART_SPEED) == 0) {
+			msg_pwarn(MSGHEADER "Warning: Changing the baud rate is not supported!\n");
+		} else {
+			sp_baud = sp_negotiate_baud(sp_baud, sp_autobaud_rates, sp_request_baud, sp_check_link);
+			if (!sp_baud)
+				return 1;
+			msg_pinfo(MSGHEADER "Using %u baud.\n", sp_baud);
+		}
+	}
+
 	/* FIXME: This assumes that serprog device bustypes are always
 	 * identical with flashrom bustype enums and that they all fit
 	 * in a single byte.
@@ -684,6 +968,45 @@ int serprog_init(void)
 	return 0;
 }
 
+/* Like the write-n part of sp_pass_writen(), but sends the data packed. The device unpacks it into its
+ * operation buffer, so that still fills up by 7 + n bytes. */
+static int sp_pass_writen_packed(void)
+{
+	uint8_t *sp;
+	uint32_t plen;
+
+	sp = malloc(10 + sp_pack_bound(sp_write_n_bytes));
+	if (!sp) {
+		msg_perr(MSGHEADER "Error: cannot allocate packed write-n buffer\n");
+		return 1;
+	}
+	plen = sp_pack(sp + 10, sp_write_n_buf, sp_write_n_bytes);
+	sp[0] = S_CMD_O_WRITEN_PACKED;
+	sp[1] = (sp_write_n_bytes >> 0) & 0xFF;
+	sp[2] = (sp_write_n_bytes >> 8) & 0xFF;
+	sp[3] = (sp_write_n_bytes >> 16) & 0xFF;
+	sp[4] = (sp_write_n_addr >> 0) & 0xFF;
+	sp[5] = (sp_write_n_addr >> 8) & 0xFF;
+	sp[6] = (sp_write_n_addr >> 16) & 0xFF;
+	sp[7] = (plen >> 0) & 0xFF;
+	sp[8] = (plen >> 8) & 0xFF;
+	sp[9] = (plen >> 16) & 0xFF;
+	if (serialport_write(sp, 10 + plen) != 0) {
+		msg_perr(MSGHEADER "Error: cannot write packed write-n command\n");
+		free(sp);
+		return 1;
+	}
+	free(sp);
+	sp_pack_raw_bytes += sp_write_n_bytes;
+	sp_pack_wire_bytes += 3 + plen;
+	sp_streamed_transmit_bytes += 10 + plen;
+	sp_streamed_transmit_ops += 1;
+	sp_opbuf_usage += 7 + sp_write_n_bytes;
+	sp_write_n_bytes = 0;
+	sp_prev_was_write = 0;
+	return 0;
+}
+
 /* Move an in flashrom buffer existing write-n operation to the on-device operation buffer. */
 static int sp_pass_writen(void)
 {
@@ -706,6 +1029,8 @@ static int sp_pass_writen(void)
 		sp_opbuf_usage += 5;
 		return 0;
 	}
+	if (sp_use_packed(S_CMD_O_WRITEN_PACKED, sp_write_n_bytes))
+		return sp_pass_writen_packed();
 	header[0] = S_CMD_O_WRITEN;
 	header[1] = (sp_write_n_bytes >> 0) & 0xFF;
 	header[2] = (sp_write_n_bytes >> 8) & 0xFF;
@@ -769,6 +1094,16 @@ static int serprog_shutdown(void *data)
 		else
 			msg_pwarn(MSGHEADER "%s: Warning: could not disable output buffers\n", __func__);
 	}
+	/* Leave the programmer at the rate the next session will start with. */
+	if (sp_baud != sp_initial_baud) {
+		const unsigned int baud = sp_request_baud(sp_initial_baud);
+		if (!baud || serialport_config(sp_fd, baud) || sp_check_link())
+			msg_pwarn(MSGHEADER "Warning: could not return to %u baud\n", sp_initial_baud);
+		sp_baud = sp_initial_baud;
+	}
+	if (sp_pack_raw_bytes)
+		msg_pdbg(MSGHEADER "Packed transfers moved %llu bytes in %llu bytes on the wire.\n",
+			 sp_pack_raw_bytes, sp_pack_wire_bytes);
 	/* FIXME: fix sockets on windows(?), especially closing */
 	serialport_shutdown(&sp_fd);
 	if (sp_max_write_n)
@@ -853,6 +1188,12 @@ static int sp_do_read_n(uint8_t * buf, const chipaddr addr, size_t len)
 	sbuf[3] = ((len >> 0) & 0xFF);
 	sbuf[4] = ((len >> 8) & 0xFF);
 	sbuf[5] = ((len >> 16) & 0xFF);
+	if (sp_use_packed(S_CMD_R_NBYTES_PACKED, len)) {
+		sp_stream_buffer_op(S_CMD_R_NBYTES_PACKED, 6, sbuf);
+		if (sp_flush_stream() != 0)
+			return 1;
+		return sp_read_packed(buf, len);
+	}
 	sp_stream_buffer_op(S_CMD_R_NBYTES, 6, sbuf);
 	if (sp_flush_stream() != 0)
 		return 1;
@@ -899,6 +1240,38 @@ void serprog_delay(unsigned int usecs)
 	sp_prev_was_write = 0;
 }
 
+/* Like S_CMD_O_SPIOP, but both directions carry packed data. */
+static int sp_spiop_packed(unsigned int writecnt, unsigned int readcnt,
+			   const unsigned char *writearr, unsigned char *readarr)
+{
+	uint8_t *parmbuf;
+	uint32_t plen;
+	int ret;
+
+	parmbuf = malloc(9 + sp_pack_bound(writecnt));
+	if (!parmbuf) {
+		msg_perr("Error: could not allocate SPI send param buffer.\n");
+		return 1;
+	}
+	plen = sp_pack(parmbuf + 9, writearr, writecnt);
+	parmbuf[0] = (writecnt >> 0) & 0xFF;
+	parmbuf[1] = (writecnt >> 8) & 0xFF;
+	parmbuf[2] = (writecnt >> 16) & 0xFF;
+	parmbuf[3] = (readcnt >> 0) & 0xFF;
+	parmbuf[4] = (readcnt >> 8) & 0xFF;
+	parmbuf[5] = (readcnt >> 16) & 0xFF;
+	parmbuf[6] = (plen >> 0) & 0xFF;
+	parmbuf[7] = (plen >> 8) & 0xFF;
+	parmbuf[8] = (plen >> 16) & 0xFF;
+	sp_pack_raw_bytes += writecnt;
+	sp_pack_wire_bytes += 3 + plen;
+	ret = sp_docommand(S_CMD_O_SPIOP_PACKED, 9 + plen, parmbuf, 0, NULL);
+	free(parmbuf);
+	if (ret)
+		return ret;
+	return sp_read_packed(readarr, readcnt);
+}
+
 static int serprog_spi_send_command(struct flashctx *flash,
 				    unsigned int writecnt, unsigned int readcnt,
 				    const unsigned char *writearr,
@@ -914,6 +1287,9 @@ static int serprog_spi_send_command(struct flashctx *flash,
 		}
 	}
 
+	if (sp_use_packed(S_CMD_O_SPIOP_PACKED, writecnt + readcnt))
+		return sp_spiop_packed(writecnt, readcnt, writearr, readarr);
+
 	parmbuf = malloc(writecnt + 6);
 	if (!parmbuf) {
 		msg_perr("Error: could not allocate SPI send param buffer.\n");
@@ -23,3 +23,7 @@
 #define S_CMD_O_SPIOP		0x13	/* Perform SPI operation.			*/
 #define S_CMD_S_SPI_FREQ	0x14	/* Set SPI clock frequency			*/
 #define S_CMD_S_PIN_STATE	0x15	/* Enable/disable output drivers		*/
+#define S_CMD_S_UART_SPEED	0x16	/* Set UART baud rate				*/
+#define S_CMD_O_SPIOP_PACKED	0x17	/* Perform SPI operation, packed data		*/
+#define S_CMD_R_NBYTES_PACKED	0x18	/* Read n bytes, packed				*/
+#define S_CMD_O_WRITEN_PACKED	0x19	/* Write to opbuf: Write-N, packed		*/
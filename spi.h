@@ -133,6 +133,11 @@
 #define SPI_SR_WEL	(0x01 << 1)
 #define SPI_SR_AAI	(0x01 << 6)
 
+/* Winbond Status Register 2 Bits */
+#define SPI_SR2_SRP1	(0x01 << 0)
+#define SPI_SR2_QE	(0x01 << 1)
+#define SPI_SR2_CMP	(0x01 << 6)
+
 /* Write Status Enable */
 #define JEDEC_EWSR		0x50
 #define JEDEC_EWSR_OUTSIZE	0x01
@@ -160,16 +165,38 @@
 /* Read Extended Address Register */
 #define JEDEC_READ_EXT_ADDR_REG		0xC8
 
+/* Suspend/resume a running erase, see `flashchip.erase_suspend` */
+#define JEDEC_ERASE_SUSPEND	0x75
+#define JEDEC_ERASE_RESUME	0x7A
+
+/* Select one die of a stacked-die package (Winbond W25M) */
+#define WINBOND_DIE_SELECT	0xC2
+
+/* Enter/exit QPI mode, where opcode, address and data use four I/O lines */
+#define JEDEC_ENTER_QPI		0x38
+#define JEDEC_EXIT_QPI		0xFF
+
+/* Set the dummy clocks of reads in QPI mode (Winbond) */
+#define JEDEC_SET_READ_PARAMS	0xC0
+
 /* Read the memory */
 #define JEDEC_READ		0x03
 #define JEDEC_READ_OUTSIZE	0x04
 /*      JEDEC_READ_INSIZE : any length */
 
+/* Read the memory after a dummy byte, also available in QPI mode */
+#define JEDEC_FAST_READ		0x0B
+#define JEDEC_FAST_READ_OUTSIZE	0x05
+/*      JEDEC_FAST_READ_INSIZE : any length */
+
 /* Write memory byte */
 #define JEDEC_BYTE_PROGRAM		0x02
 #define JEDEC_BYTE_PROGRAM_OUTSIZE	0x05
 #define JEDEC_BYTE_PROGRAM_INSIZE	0x00
 
+/* Write memory page with the data on four I/O lines */
+#define JEDEC_QUAD_PAGE_PROGRAM		0x32
+
 /* Write AAI word (SST25VF080B) */
 #define JEDEC_AAI_WORD_PROGRAM			0xad
 #define JEDEC_AAI_WORD_PROGRAM_OUTSIZE		0x06
@@ -180,6 +207,10 @@
    From ANY mode (3-bytes or 4-bytes) it works with 4-byte address */
 #define JEDEC_READ_4BA		0x13
 
+/* Read the memory with 4-byte address after a dummy byte
+   From ANY mode (3-bytes or 4-bytes) it works with 4-byte address */
+#define JEDEC_READ_4BA_FAST	0x0C
+
 /* Write memory byte with 4-byte address
    From ANY mode (3-bytes or 4-bytes) it works with 4-byte address */
 #define JEDEC_BYTE_PROGRAM_4BA	0x12
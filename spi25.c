@@ -362,7 +362,7 @@ static int spi_write_extended_address_register(struct flashctx *const flash, con
 	return result;
 }
 
-static int spi_set_extended_address(struct flashctx *const flash, const uint8_t addr_high)
+int spi_set_extended_address(struct flashctx *const flash, const uint8_t addr_high)
 {
 	if (flash->address_high_byte != addr_high &&
 	    spi_write_extended_address_register(flash, addr_high))
@@ -371,9 +371,105 @@ static int spi_set_extended_address(struct flashctx *const flash, const uint8_t
 	return 0;
 }
 
+static int spi_select_die(struct flashctx *const flash, const unsigned int die)
+{
+	const unsigned char cmd[] = { WINBOND_DIE_SELECT, die };
+
+	if (flash->selected_die == (int)die)
+		return 0;
+	if (spi_send_command(flash, sizeof(cmd), 0, cmd, NULL)) {
+		msg_cerr("%s failed to select die %u\n", __func__, die);
+		return 1;
+	}
+	flash->selected_die = die;
+	return 0;
+}
+
+/**
+ * Check if a die of a stacked-die chip (or die 0 of any other chip) is still
+ * busy with a deferred erase or program, see `flash->defer_wip`.
+ *
+ * @return 1 if the die is busy, 0 if it's idle, -1 on errors
+ */
+int spi_die_busy(struct flashctx *const flash, const unsigned int die)
+{
+	if (!(flash->busy_dies & 1 << die))
+		return 0;
+	if (flash->chip->dies > 1 && spi_select_die(flash, die))
+		return -1;
+	if (spi_read_status_register(flash, JEDEC_RDSR) & SPI_SR_WIP)
+		return 1;
+	flash->busy_dies &= ~(1 << die);
+	return 0;
+}
+
+/**
+ * Suspend a running erase. Until spi_erase_resume() is called, the chip
+ * can be read, except for the block that is being erased.
+ *
+ * @return 0 on success, non-zero otherwise
+ */
+int spi_erase_suspend(struct flashctx *const flash)
+{
+	const unsigned char cmd[] = { JEDEC_ERASE_SUSPEND };
+
+	if (spi_send_command(flash, sizeof(cmd), 0, cmd, NULL)) {
+		msg_cerr("%s failed during command execution\n", __func__);
+		return 1;
+	}
+	programmer_delay(flash->chip->erase_suspend.latency);
+	/* WIP is cleared as soon as the erase is suspended (or finished). */
+	if (spi_read_status_register(flash, JEDEC_RDSR) & SPI_SR_WIP) {
+		msg_cerr("%s: erase wasn't suspended in time\n", __func__);
+		return 1;
+	}
+	return 0;
+}
+
+/** Resume an erase suspended with spi_erase_suspend(). */
+int spi_erase_resume(struct flashctx *const flash)
+{
+	const unsigned char cmd[] = { JEDEC_ERASE_RESUME };
+
+	if (spi_send_command(flash, sizeof(cmd), 0, cmd, NULL)) {
+		msg_cerr("%s failed during command execution\n", __func__);
+		return 1;
+	}
+	return 0;
+}
+
+/* Block protection of stacked-die chips is per die, so unlock each of them. */
+int spi_disable_blockprotect_dies(struct flashctx *const flash)
+{
+	unsigned int die;
+	int ret = 0;
+
+	for (die = 0; die < flash->chip->dies; ++die) {
+		if (spi_select_die(flash, die))
+			return 1;
+		ret |= spi_disable_blockprotect(flash);
+	}
+	return ret;
+}
+
 static int spi_prepare_address(struct flashctx *const flash, uint8_t cmd_buf[],
-			       const bool native_4ba, const unsigned int addr)
+			       const bool native_4ba, unsigned int addr)
 {
+	/* Stacked dies each decode their own address space. */
+	if (flash->chip->dies > 1) {
+		const unsigned int die_size = flash->chip->total_size * 1024 / flash->chip->dies;
+		const unsigned int die = addr / die_size;
+
+		addr %= die_size;
+		if (spi_select_die(flash, die))
+			return -1;
+		/* The die would ignore us. */
+		if (flash->busy_dies & 1 << die) {
+			spi_poll_wip(flash, 10);
+			flash->busy_dies &= ~(1 << die);
+		}
+	}
+
 	if (native_4ba || flash->in_4ba_mode) {
 		if (!spi_master_4ba(flash)) {
 			msg_cwarn("4-byte address requested but master can't handle 4-byte addresses.\n");
@@ -447,6 +543,12 @@ static int spi_write_cmd(struct flashctx *const flash, const uint8_t op,
 	if (result)
 		msg_cerr("%s failed during command execution at address 0x%x\n", __func__, addr);
 
+	/* The schedulers in flashrom.c poll the chip (or each die of stacked chips) themselves. */
+	if (flash->defer_wip) {
+		flash->busy_dies |= 1 << (flash->chip->dies > 1 ? flash->selected_die : 0);
+		return result;
+	}
+
 	const int status = spi_poll_wip(flash, poll_delay);
 
 	return result ? result : status;
@@ -633,23 +735,34 @@ erasefunc_t *spi_get_erasefn_from_opcode(uint8_t opcode)
 
 static int spi_nbyte_program(struct flashctx *flash, unsigned int addr, const uint8_t *bytes, unsigned int len)
 {
-	const bool native_4ba = flash->chip->feature_bits & FEATURE_4BA_WRITE && spi_master_4ba(flash);
-	const uint8_t op = native_4ba ? JEDEC_BYTE_PROGRAM_4BA : JEDEC_BYTE_PROGRAM;
+	/* In QPI mode, the regular page program runs on four lines already. */
+	const bool native_4ba = flash->chip->feature_bits & FEATURE_4BA_WRITE && spi_master_4ba(flash) &&
+				!flash->in_qpi_mode;
+	uint8_t op = native_4ba ? JEDEC_BYTE_PROGRAM_4BA : JEDEC_BYTE_PROGRAM;
+	if (flash->quad_program && !native_4ba)
+		op = JEDEC_QUAD_PAGE_PROGRAM;
 	return spi_write_cmd(flash, op, native_4ba, addr, bytes, len, 10);
 }
 
 int spi_nbyte_read(struct flashctx *flash, unsigned int address, uint8_t *bytes,
 		   unsigned int len)
 {
-	const bool native_4ba =	flash->chip->feature_bits & FEATURE_4BA_READ && spi_master_4ba(flash);
-	uint8_t cmd[1 + JEDEC_MAX_ADDR_LEN] = { native_4ba ? JEDEC_READ_4BA : JEDEC_READ, };
+	const bool native_4ba =	flash->chip->feature_bits & FEATURE_4BA_READ && spi_master_4ba(flash) &&
+				!flash->in_qpi_mode;
+	/* QPI mode has no plain read, fast read takes one dummy byte (two clocks). */
+	const unsigned int dummy_len = flash->in_qpi_mode ? 1 : 0;
+	uint8_t cmd[1 + JEDEC_MAX_ADDR_LEN + 1] = { native_4ba ? JEDEC_READ_4BA : JEDEC_READ, };
+
+	if (flash->in_qpi_mode)
+		cmd[0] = JEDEC_FAST_READ;
 
 	const int addr_len = spi_prepare_address(flash, cmd, native_4ba, address);
 	if (addr_len < 0)
 		return 1;
+	cmd[1 + addr_len] = 0xff;
 
 	/* Send Read */
-	return spi_send_command(flash, 1 + addr_len, len, cmd, bytes);
+	return spi_send_command(flash, 1 + addr_len + dummy_len, len, cmd, bytes);
 }
 
 /*
@@ -867,3 +980,97 @@ int spi_exit_4ba(struct flashctx *flash)
 {
 	return spi_enter_exit_4ba(flash, false);
 }
+
+static int spi_exit_qpi(struct flashctx *const flash)
+{
+	const unsigned char cmd = JEDEC_EXIT_QPI;
+
+	const int ret = spi_send_command(flash, sizeof(cmd), 0, &cmd, NULL);
+	if (!ret)
+		flash->in_qpi_mode = false;
+	return ret;
+}
+
+/* Returns 0 if the chip is in QPI mode, 1 if it isn't, and -1 if its mode is unknown. */
+static int spi_enter_qpi(struct flashctx *const flash)
+{
+	const unsigned char enter = JEDEC_ENTER_QPI;
+	const unsigned char rdid = JEDEC_RDID;
+	/* Two dummy clocks for fast reads, i.e. the dummy byte sent by spi_nbyte_read(). */
+	const unsigned char set_params[] = { JEDEC_SET_READ_PARAMS, 0x00 };
+	unsigned char id[3];
+
+	if (spi_send_command(flash, sizeof(enter), 0, &enter, NULL))
+		return 1;
+	flash->in_qpi_mode = true;
+
+	/* Make sure the chip understands us before we rely on it. */
+	if (!spi_send_command(flash, sizeof(rdid), sizeof(id), &rdid, id) &&
+	    id[0] == flash->chip->manufacture_id &&
+	    (id[1] << 8 | id[2]) == flash->chip->model_id &&
+	    !spi_send_command(flash, sizeof(set_params), 0, set_params, NULL))
+		return 0;
+
+	msg_cdbg("Chip didn't respond in QPI mode. ");
+	if (spi_exit_qpi(flash))
+		return -1;
+	return 1;
+}
+
+/*
+ * Use the widest I/O mode that both the chip and the master support: QPI
+ * mode, quad input page program or single I/O. Quad modes need the QE bit
+ * which is non-volatile on most chips, so we never set it ourselves.
+ *
+ * Returns 0 on success, also if it falls back to single I/O, and non-zero
+ * if the chip was left in an unknown mode.
+ */
+int spi_prepare_io_mode(struct flashctx *const flash)
+{
+	const unsigned char rdsr2 = WINBOND_RDSR_2;
+	unsigned char sr2;
+
+	flash->in_qpi_mode = false;
+	flash->quad_program = false;
+
+	if (!(flash->chip->feature_bits & FEATURE_QUAD_PROGRAM))
+		return 0;
+	if (!spi_master_quad_in(flash) && !spi_master_qpi(flash)) {
+		msg_cdbg("Programmer only supports single I/O.\n");
+		return 0;
+	}
+	if (spi_send_command(flash, sizeof(rdsr2), sizeof(sr2), &rdsr2, &sr2) || !(sr2 & SPI_SR2_QE)) {
+		msg_cdbg("Quad Enable bit of the chip is not set, using single I/O.\n");
+		return 0;
+	}
+
+	if ((flash->chip->feature_bits & FEATURE_QPI) && spi_master_qpi(flash)) {
+		const int ret = spi_enter_qpi(flash);
+		if (ret < 0)
+			return 1;
+		if (!ret) {
+			msg_cdbg("Using QPI mode.\n");
+			return 0;
+		}
+	}
+	if (spi_master_quad_in(flash)) {
+		flash->quad_program = true;
+		msg_cdbg("Using quad input page program.\n");
+	}
+	return 0;
+}
+
+int spi_finalize_io_mode(struct flashctx *const flash)
+{
+	int ret = 0;
+
+	flash->quad_program = false;
+	/* Leave stacked-die chips with die 0 selected, as after power-up. */
+	if (flash->chip->dies > 1 && flash->selected_die > 0 && spi_select_die(flash, 0))
+		ret = 1;
+	if (flash->in_qpi_mode && spi_exit_qpi(flash)) {
+		msg_cerr("Failed to leave QPI mode!\n");
+		return 1;
+	}
+	return ret;
+}
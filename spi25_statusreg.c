@@ -78,10 +78,29 @@ int spi_write_status_enable(struct flashctx *flash)
 	return result;
 }
 
+static int spi_wait_status_write(struct flashctx *flash)
+{
+	int i = 0;
+
+	/* WRSR performs a self-timed erase before the changes take effect.
+	 * This may take 50-85 ms in most cases, and some chips apparently
+	 * allow running RDSR only once. Therefore pick an initial delay of
+	 * 100 ms, then wait in 10 ms steps until a total of 5 s have elapsed.
+	 */
+	programmer_delay(100 * 1000);
+	while (spi_read_status_register(flash, JEDEC_RDSR) & SPI_SR_WIP) {
+		if (++i > 490) {
+			msg_cerr("Error: WIP bit after WRSR never cleared\n");
+			return TIMEOUT_ERROR;
+		}
+		programmer_delay(10 * 1000);
+	}
+	return 0;
+}
+
 static int spi_write_status_register_flag(struct flashctx *flash, uint8_t sr_addr, int status, const unsigned char enable_opcode)
 {
 	int result;
-	int i = 0;
 	/*
 	 * WRSR requires either EWSR or WREN depending on chip type.
 	 * The code below relies on the fact hat EWSR and WREN have the same
@@ -113,20 +132,7 @@ static int spi_write_status_register_flag(struct flashctx *flash, uint8_t sr_add
 		 */
 		return result;
 	}
-	/* WRSR performs a self-timed erase before the changes take effect.
-	 * This may take 50-85 ms in most cases, and some chips apparently
-	 * allow running RDSR only once. Therefore pick an initial delay of
-	 * 100 ms, then wait in 10 ms steps until a total of 5 s have elapsed.
-	 */
-	programmer_delay(100 * 1000);
-	while (spi_read_status_register(flash, JEDEC_RDSR) & SPI_SR_WIP) {
-		if (++i > 490) {
-			msg_cerr("Error: WIP bit after WRSR never cleared\n");
-			return TIMEOUT_ERROR;
-		}
-		programmer_delay(10 * 1000);
-	}
-	return 0;
+	return spi_wait_status_write(flash);
 }
 
 int spi_write_status_register(struct flashctx *flash, int status)
@@ -882,3 +888,142 @@ int spi_prettyprint_status_register_sst25vf040b(struct flashctx *flash)
 	msg_cdbg("Resulting block protection : %s\n", bpt[(status & 0x1c) >> 2]);
 	return 0;
 }
+
+/* === Winbond === */
+
+#define W25Q_SR1_BP_MASK	(0x07 << 2)
+#define W25Q_SR1_TB		(1 << 5)
+#define W25Q_SR1_SEC		(1 << 6)
+
+/*
+ * Decodes BP0-2, TB and SEC in SR1 and CMP in SR2 of W25Q chips. BP selects 2^(BP-1) units at the top
+ * (TB=0) or bottom (TB=1) of the chip, or all of it for BP=7. A unit is 1/64 of the chip, but at least
+ * 64 kB. With SEC=1 a unit is 4 kB and at most 32 kB are selected. CMP=1 protects everything else.
+ */
+static void w25q_protected_range(const struct flashctx *flash, uint8_t sr1, uint8_t sr2,
+				 chipoff_t *start, chipsize_t *len)
+{
+	const chipsize_t size = flash->chip->total_size * 1024;
+	const unsigned int bp = (sr1 & W25Q_SR1_BP_MASK) >> 2;
+	const bool bottom = sr1 & W25Q_SR1_TB;
+	chipsize_t prot;
+
+	if (bp == 0)
+		prot = 0;
+	else if (bp == 7)
+		prot = size;
+	else if (sr1 & W25Q_SR1_SEC)
+		prot = min(4 * 1024 << (bp - 1), 32 * 1024);
+	else
+		prot = min(max(size / 64, 64 * 1024) << (bp - 1), size);
+
+	if (!(sr2 & SPI_SR2_CMP)) {
+		*start = bottom ? 0 : size - prot;
+		*len = prot;
+	} else {
+		*start = bottom ? prot : 0;
+		*len = size - prot;
+	}
+}
+
+int spi_protection_bp2_tb_sec_cmp(struct flashctx *flash, struct protection *prot)
+{
+	const uint8_t sr1 = spi_read_status_register(flash, JEDEC_RDSR);
+	const uint8_t sr2 = spi_read_status_register(flash, WINBOND_RDSR_2);
+	chipoff_t start;
+	chipsize_t len;
+
+	prot->count = 0;
+	w25q_protected_range(flash, sr1, sr2, &start, &len);
+	if (!len)
+		return 0;
+	/* SRP1 locks the status registers until the next power cycle or for good. */
+	return protection_add(prot, start, len, false, sr2 & SPI_SR2_SRP1);
+}
+
+int spi_prettyprint_status_register_bp2_tb_sec_cmp(struct flashctx *flash)
+{
+	const uint8_t sr1 = spi_read_status_register(flash, JEDEC_RDSR);
+	const uint8_t sr2 = spi_read_status_register(flash, WINBOND_RDSR_2);
+	chipoff_t start;
+	chipsize_t len;
+
+	spi_prettyprint_status_register_hex(sr1);
+	msg_cdbg("Chip status register 2 is 0x%02x.\n", sr2);
+	spi_prettyprint_status_register_srwd(sr1);
+	msg_cdbg("Chip status register: Sector/Block Protect (SEC) is %sset\n", (sr1 & W25Q_SR1_SEC) ? "" : "not ");
+	msg_cdbg("Chip status register: Top/Bottom (TB) is %s\n", (sr1 & W25Q_SR1_TB) ? "bottom" : "top");
+	spi_prettyprint_status_register_bp(sr1, 2);
+	spi_prettyprint_status_register_welwip(sr1);
+	msg_cdbg("Chip status register 2: Complement Protect (CMP) is %sset\n", (sr2 & SPI_SR2_CMP) ? "" : "not ");
+	msg_cdbg("Chip status register 2: Status Register Protect 1 (SRP1) is %sset\n",
+		 (sr2 & SPI_SR2_SRP1) ? "" : "not ");
+
+	w25q_protected_range(flash, sr1, sr2, &start, &len);
+	if (len)
+		msg_cdbg("Resulting block protection : 0x%06x-0x%06x\n", start, start + len - 1);
+	else
+		msg_cdbg("Resulting block protection : none\n");
+	return 0;
+}
+
+/* Clears BP0-2, TB and SEC in SR1 and CMP in SR2. Both are written at once, which all W25Q chips support. */
+int spi_disable_blockprotect_bp2_tb_sec_cmp(struct flashctx *flash)
+{
+	uint8_t sr1 = spi_read_status_register(flash, JEDEC_RDSR);
+	uint8_t sr2 = spi_read_status_register(flash, WINBOND_RDSR_2);
+	chipoff_t start;
+	chipsize_t len;
+	int result;
+
+	w25q_protected_range(flash, sr1, sr2, &start, &len);
+	if (!len) {
+		msg_cdbg2("Block protection is disabled.\n");
+		return 0;
+	}
+	if (sr2 & SPI_SR2_SRP1) {
+		msg_cerr("The status registers are locked, disabling block protection is impossible.\n");
+		return 1;
+	}
+
+	msg_cdbg("Some block protection in effect, disabling... ");
+	struct spi_command cmds[] = {
+	{
+		.writecnt	= JEDEC_WREN_OUTSIZE,
+		.writearr	= (const unsigned char[]){ JEDEC_WREN },
+		.readcnt	= 0,
+		.readarr	= NULL,
+	}, {
+		.writecnt	= JEDEC_WRSR_OUTSIZE + 1,
+		.writearr	= (const unsigned char[]){
+			JEDEC_WRSR,
+			sr1 & ~(W25Q_SR1_BP_MASK | W25Q_SR1_TB | W25Q_SR1_SEC | SPI_SR_WEL | SPI_SR_WIP),
+			sr2 & ~SPI_SR2_CMP,
+		},
+		.readcnt	= 0,
+		.readarr	= NULL,
+	}, {
+		.writecnt	= 0,
+		.writearr	= NULL,
+		.readcnt	= 0,
+		.readarr	= NULL,
+	}};
+	result = spi_send_multicommand(flash, cmds);
+	if (!result)
+		result = spi_wait_status_write(flash);
+	if (result) {
+		msg_cerr("Writing the status registers failed.\n");
+		return result;
+	}
+
+	sr1 = spi_read_status_register(flash, JEDEC_RDSR);
+	sr2 = spi_read_status_register(flash, WINBOND_RDSR_2);
+	w25q_protected_range(flash, sr1, sr2, &start, &len);
+	if (len) {
+		msg_cerr("Block protection could not be disabled!\n");
+		flash->chip->printlock(flash);
+		return 1;
+	}
+	msg_cdbg("disabled.\n");
+	return 0;
+}
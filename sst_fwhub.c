@@ -23,73 +23,20 @@
 /* Adapted from the Intel FW hub stuff for 82802ax parts. */
 
 #include "flash.h"
+#include "chipdrivers.h"
 
-static int check_sst_fwhub_block_lock(struct flashctx *flash, int offset)
-{
-	chipaddr registers = flash->virtual_registers;
-	uint8_t blockstatus;
-
-	blockstatus = chip_readb(flash, registers + offset + 2);
-	msg_cdbg("Lock status for 0x%06x (size 0x%06x) is %02x, ",
-		     offset, flash->chip->page_size, blockstatus);
-	switch (blockstatus & 0x3) {
-	case 0x0:
-		msg_cdbg("full access\n");
-		break;
-	case 0x1:
-		msg_cdbg("write locked\n");
-		break;
-	case 0x2:
-		msg_cdbg("locked open\n");
-		break;
-	case 0x3:
-		msg_cdbg("write locked down\n");
-		break;
-	}
-	/* Return content of the write_locked bit */
-	return blockstatus & 0x1;
-}
-
-static int clear_sst_fwhub_block_lock(struct flashctx *flash, int offset)
-{
-	chipaddr registers = flash->virtual_registers;
-	uint8_t blockstatus;
-
-	blockstatus = check_sst_fwhub_block_lock(flash, offset);
-
-	if (blockstatus) {
-		msg_cdbg("Trying to clear lock for 0x%06x... ", offset);
-		chip_writeb(flash, 0, registers + offset + 2);
-
-		blockstatus = check_sst_fwhub_block_lock(flash, offset);
-		msg_cdbg("%s\n", (blockstatus) ? "failed" : "OK");
-	}
-
-	return blockstatus;
-}
+/*
+ * The SST FWH chips have one lock register per page, which are the blocks of
+ * the second erase function. Bit 0 is the write lock and bit 1 the lockdown,
+ * like in the generic FWH register space in jedec.c, which caches them.
+ */
 
 int printlock_sst_fwhub(struct flashctx *flash)
 {
-	int i;
-
-	for (i = 0; i < flash->chip->total_size * 1024; i += flash->chip->page_size)
-		check_sst_fwhub_block_lock(flash, i);
-
-	return 0;
+	return printlock_regspace2_block_eraser_1(flash);
 }
 
 int unlock_sst_fwhub(struct flashctx *flash)
 {
-	int i, ret=0;
-
-	for (i = 0; i < flash->chip->total_size * 1024; i += flash->chip->page_size)
-	{
-		if (clear_sst_fwhub_block_lock(flash, i))
-		{
-			msg_cwarn("Warning: Unlock Failed for block 0x%06x\n", i);
-			ret++;
-		}
-	}
-	return ret;
+	return unlock_regspace2_block_eraser_1(flash);
 }
-
@@ -40,21 +40,72 @@ static clockid_t clock_id = CLOCK_MONOTONIC;
 static clockid_t clock_id = CLOCK_REALTIME;
 #endif
 
+/*
+ * Waits longer than `sleep_threshold` sleep until `sleep_slack` before their
+ * end and only spin for the rest, so a long erase doesn't keep a CPU busy.
+ * Both are derived from the wakeup latency measured in clock_calibrate_sleep().
+ * A threshold of 0 means to always spin.
+ */
+static unsigned int sleep_threshold = 0;
+static unsigned int sleep_slack = 0;
+
+static struct timespec timespec_add_usecs(const struct timespec *const ts, const unsigned long usecs)
+{
+	const long nsec = ts->tv_nsec + (usecs % (1000 * 1000)) * 1000L;
+	const struct timespec sum = {
+		ts->tv_sec + usecs / (1000 * 1000) + nsec / (1000 * 1000 * 1000),
+		nsec % (1000 * 1000 * 1000)
+	};
+	return sum;
+}
+
 static void clock_usec_delay(int usecs)
 {
 	struct timespec now;
 	clock_gettime(clock_id, &now);
 
-	const long end_nsec = now.tv_nsec + usecs * 1000L;
-	const struct timespec end = {
-		end_nsec / (1000 * 1000 * 1000) + now.tv_sec,
-		end_nsec % (1000 * 1000 * 1000)
-	};
+	const struct timespec end = timespec_add_usecs(&now, usecs);
+#ifdef TIMER_ABSTIME
+	if (sleep_threshold && (unsigned int)usecs > sleep_threshold) {
+		const struct timespec wakeup = timespec_add_usecs(&now, usecs - sleep_slack);
+		while (clock_nanosleep(clock_id, TIMER_ABSTIME, &wakeup, NULL) == EINTR)
+			;
+	}
+#endif
 	do {
 		clock_gettime(clock_id, &now);
 	} while (now.tv_sec < end.tv_sec || (now.tv_sec == end.tv_sec && now.tv_nsec < end.tv_nsec));
 }
 
+/* Measures how late the scheduler wakes us up from short sleeps. */
+static void clock_calibrate_sleep(void)
+{
+#ifdef TIMER_ABSTIME
+	struct timespec start, wakeup, now;
+	unsigned long latency, max_latency = 0;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		clock_gettime(clock_id, &start);
+		wakeup = timespec_add_usecs(&start, 100);
+		if (clock_nanosleep(clock_id, TIMER_ABSTIME, &wakeup, NULL))
+			return;
+		clock_gettime(clock_id, &now);
+		latency = (now.tv_sec - wakeup.tv_sec) * 1000000L + (now.tv_nsec - wakeup.tv_nsec) / 1000;
+		if (latency > max_latency)
+			max_latency = latency;
+	}
+	/* Keep a safety margin to the worst case we've seen, and sleep
+	   only if that leaves at least half of the delay to sleep. */
+	if (max_latency > 10000)
+		return;
+	sleep_slack = 2 * max_latency + 20;
+	sleep_threshold = 2 * sleep_slack;
+	msg_pdbg("Wakeup latency is up to %luus, sleeping in delays longer than %uus.\n",
+		 max_latency, sleep_threshold);
+#endif
+}
+
 static int clock_check_res(void)
 {
 	struct timespec res;
@@ -63,6 +114,7 @@ static int clock_check_res(void)
 			msg_pinfo("Using clock_gettime for delay loops (clk_id: %d, resolution: %ldns).\n",
 				  (int)clock_id, res.tv_nsec);
 			use_clock_gettime = true;
+			clock_calibrate_sleep();
 			return 1;
 		}
 	} else if (clock_id != CLOCK_REALTIME && errno == EINVAL) {